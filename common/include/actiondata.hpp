@@ -0,0 +1,85 @@
+#pragma once
+
+#include <eosio/action.hpp>
+#include <eosio/datastream.hpp>
+
+#include <algorithm>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// in place decoding of action data for the contracts' own apply, strings are views into a stack buffer
+// so the hot actions run without the vector and string copies execute_action makes
+namespace actiondata {
+
+    using namespace eosio;
+
+    // transfer data with the longest memo the tokens accept: from, to, quantity, a 2 byte length and 256 bytes
+    constexpr uint32_t MAX_MEMO_ACTION_SIZE = 8 + 8 + 16 + 2 + 256;
+
+    // a string as a view into the stream's buffer, valid as long as the buffer is
+    inline void read(datastream<const char*>& ds, std::string_view& v) {
+        unsigned_int size;
+        ds >> size;
+        check(ds.remaining() >= size.value, "datastream attempted to read past the end");
+        v = std::string_view(ds.pos(), size.value);
+        ds.skip(size.value);
+    }
+
+    template<typename T>
+    void read(datastream<const char*>& ds, T& v) {
+        ds >> v;
+    }
+
+    /**
+     * The first `N` bytes of the current action's data, read once onto the stack.
+     * Data longer than `N` is `complete() == false` and is left to execute_action.
+     */
+    template<uint32_t N>
+    class reader {
+        public:
+            reader() : _size(action_data_size()) {
+                read_action_data(_data, std::min(_size, N));
+            }
+
+            bool complete() const { return _size <= N; }
+
+            datastream<const char*> stream() const { return datastream<const char*>(_data, std::min(_size, N)); }
+
+            // decodes the whole action data into `args`, false when it did not fit
+            template<typename... Args>
+            bool read(Args&... args) const {
+                if (!complete()) {
+                    return false;
+                }
+                auto ds = stream();
+                (actiondata::read(ds, args), ...);
+                return true;
+            }
+
+        private:
+            char _data[N];
+            uint32_t _size;
+    };
+
+    /**
+     * Runs a read only query from the contract's own apply and sets its result as the return value.
+     * execute_action only takes void members, the return value is set by the dispatcher CDT
+     * generates, which an own apply does not use.
+     */
+    template<typename T, typename R, typename... Args>
+    void execute_query(name self, name code, R (T::*func)(Args...)) {
+        std::vector<char> buffer(action_data_size());
+        read_action_data(buffer.data(), buffer.size());
+
+        std::tuple<std::decay_t<Args>...> args;
+        datastream<const char*> ds(buffer.data(), buffer.size());
+        ds >> args;
+
+        T inst(self, code, ds);
+        auto result = pack(std::apply([&](auto&... a) { return (inst.*func)(a...); }, args));
+        set_action_return_value(result.data(), result.size());
+    }
+
+}
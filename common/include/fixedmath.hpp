@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// exact integer ratio math shared by the contracts, every function is constexpr and overflow free for 64 bit operands
+namespace fixedmath {
+
+    typedef unsigned __int128 u128;
+
+    // Q64.64 fixed point, the upper 64 bits are the integer part
+    constexpr u128 one = u128(1) << 64;
+
+    // floor(a * b / c), the 128 bit product never overflows
+    constexpr u128 mul_div(uint64_t a, uint64_t b, uint64_t c) {
+        return u128(a) * b / c;
+    }
+
+    // floor(num / den) as Q64.64, num must be below 2^64
+    constexpr u128 to_q64(uint64_t num, uint64_t den) {
+        return (u128(num) << 64) / den;
+    }
+
+    // floor(a * q) for a Q64.64 q, split in halves so the product stays within 128 bits
+    constexpr u128 mul_q64(uint64_t a, u128 q) {
+        return u128(a) * uint64_t(q >> 64) + ((u128(a) * uint64_t(q)) >> 64);
+    }
+
+    static_assert(mul_div(UINT64_MAX, UINT64_MAX, UINT64_MAX) == UINT64_MAX);
+    static_assert(mul_q64(UINT64_MAX, one) == UINT64_MAX);
+    static_assert(mul_q64(10, to_q64(3, 2)) == 15);
+    static_assert(mul_q64(uint64_t(1) << 62, to_q64(1, 3)) == (uint64_t(1) << 62) / 3);
+
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <eosio/asset.hpp>
+#include <eosio/eosio.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// the token actions shared by ifttoken and stakedtoken, each contract picks its policies at compile time
+// and a policy that is switched off leaves no code behind
+namespace tokencore {
+
+    using namespace eosio;
+
+    // issue is only bounded by max_supply
+    struct no_issue_cap {
+        static void check_issue(const asset& supply, const asset& quantity) {}
+    };
+
+    // one issue may add at most supply / Divisor once there is a supply
+    template<int64_t Divisor>
+    struct issue_cap {
+        static void check_issue(const asset& supply, const asset& quantity) {
+            if (supply.amount > 0) {
+                check(quantity.amount <= supply.amount / Divisor, "issue quantity too much");
+            }
+        }
+    };
+
+    // balances are never locked. A lock policy has the same members with `enabled` set:
+    //   can_spend(owner, balance) - whether `owner` may keep `balance` after a debit,
+    //   on_receive(owner, quantity, ram_payer, st) - locks a credit,
+    //   on_close(owner, sym) - erases what is stored next to a closed balance,
+    //   accepts_batch(to) - whether `to` may be a recipient of `transfers`, which notifies `transfers`
+    //   and not `transfer`.
+    // Transfers from and to the issuer are never locked.
+    struct no_lock {
+        static constexpr bool enabled = false;
+    };
+
+    /**
+     * The `accounts` and `stat` bookkeeping of an eosio.token style contract. `Accounts` and `Stats`
+     * are the contract's multi_index types, so the table layout and ABI stay with the contract.
+     */
+    template<typename Accounts, typename Stats, typename IssueCap, typename Lock>
+    class basic_token {
+        public:
+            basic_token(const name& self, Lock lock = {}) : _self(self), _lock(lock) {}
+
+            void create(const name& issuer, const asset& maximum_supply) {
+                require_auth(_self);
+
+                auto sym = maximum_supply.symbol;
+                check(sym.is_valid(), "invalid symbol name");
+                check(maximum_supply.is_valid(), "invalid supply");
+                check(maximum_supply.amount > 0, "max-supply must be positive");
+
+                Stats statstable(_self, sym.code().raw());
+                auto existing = statstable.find(sym.code().raw());
+                check(existing == statstable.end(), "token with symbol already exists");
+
+                statstable.emplace(_self, [&](auto& s) {
+                    s.supply.symbol = maximum_supply.symbol;
+                    s.max_supply    = maximum_supply;
+                    s.issuer        = issuer;
+                });
+            }
+
+            void issue(const name& to, const asset& quantity, std::string_view memo) {
+                mint(to, quantity, memo, false);
+            }
+
+            // issue straight into `to`'s balance, locked like a transfer from the issuer would be
+            void issueto(const name& to, const asset& quantity, std::string_view memo) {
+                mint(to, quantity, memo, true);
+            }
+
+            void retire(const asset& quantity, std::string_view memo) {
+                auto sym = quantity.symbol;
+                check(sym.is_valid(), "invalid symbol name");
+                check(memo.size() <= 256, "memo has more than 256 bytes");
+
+                Stats statstable(_self, sym.code().raw());
+                auto existing = statstable.find(sym.code().raw());
+                check(existing != statstable.end(), "token with symbol does not exist");
+                const auto& st = *existing;
+
+                require_auth(st.issuer);
+                check(quantity.is_valid(), "invalid quantity");
+                check(quantity.amount > 0, "must retire positive quantity");
+
+                check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
+
+                statstable.modify(st, same_payer, [&](auto& s) {
+                    s.supply -= quantity;
+                });
+
+                sub_balance(st.issuer, quantity, false, st.issuer);
+            }
+
+            // retire from `owner`'s balance, spent through the lock policy like a transfer. The caller
+            // checks who may burn, the balance row keeps its payer since `owner` did not authorize
+            void burnfrom(const name& owner, const asset& quantity) {
+                auto sym = quantity.symbol;
+                check(sym.is_valid(), "invalid symbol name");
+
+                Stats statstable(_self, sym.code().raw());
+                auto existing = statstable.find(sym.code().raw());
+                check(existing != statstable.end(), "token with symbol does not exist");
+                const auto& st = *existing;
+
+                check(quantity.is_valid(), "invalid quantity");
+                check(quantity.amount > 0, "must burn positive quantity");
+                check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
+
+                require_recipient(owner);
+
+                statstable.modify(st, same_payer, [&](auto& s) {
+                    s.supply -= quantity;
+                });
+
+                sub_balance(owner, quantity, owner != st.issuer, same_payer);
+            }
+
+            void transfer(const name& from, const name& to, const asset& quantity, std::string_view memo) {
+                check(from != to, "cannot transfer to self");
+                require_auth(from);
+                check(is_account(to), "to account does not exist");
+                auto sym = quantity.symbol.code();
+                Stats statstable(_self, sym.raw());
+                const auto& st = statstable.get(sym.raw());
+
+                require_recipient(from);
+                require_recipient(to);
+
+                check(quantity.is_valid(), "invalid quantity");
+                check(quantity.amount > 0, "must transfer positive quantity");
+                check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
+                check(memo.size() <= 256, "memo has more than 256 bytes");
+
+                auto payer = has_auth(to) ? to : from;
+
+                sub_balance(from, quantity, from != st.issuer, from);
+                add_balance(to, quantity, payer);
+                if constexpr (Lock::enabled) {
+                    if (to != st.issuer) {
+                        _lock.on_receive(to, quantity, payer, st);
+                    }
+                }
+            }
+
+            template<typename Entry>
+            void transfers(const name& from, const symbol& sym, const std::vector<Entry>& transfers) {
+                require_auth(from);
+                check(transfers.size() > 0, "no transfers");
+                auto sym_code = sym.code();
+                Stats statstable(_self, sym_code.raw());
+                const auto& st = statstable.get(sym_code.raw());
+                check(sym == st.supply.symbol, "symbol precision mismatch");
+
+                require_recipient(from);
+
+                asset total(0, sym);
+                for (const auto& t : transfers) {
+                    check(t.to != from, "cannot transfer to self");
+                    check(is_account(t.to), "to account does not exist");
+                    if constexpr (Lock::enabled) {
+                        check(_lock.accepts_batch(t.to), "use transfer to send to " + t.to.to_string());
+                    }
+                    check(t.amount > 0, "must transfer positive quantity");
+                    check(t.memo.size() <= 256, "memo has more than 256 bytes");
+                    total += asset(t.amount, sym);
+                    require_recipient(t.to);
+                }
+
+                sub_balance(from, total, from != st.issuer, from);
+                for (const auto& t : transfers) {
+                    auto payer = has_auth(t.to) ? t.to : from;
+                    auto quantity = asset(t.amount, sym);
+                    add_balance(t.to, quantity, payer);
+                    if constexpr (Lock::enabled) {
+                        if (t.to != st.issuer) {
+                            _lock.on_receive(t.to, quantity, payer, st);
+                        }
+                    }
+                }
+            }
+
+            void open(const name& owner, const symbol& symbol, const name& ram_payer) {
+                require_auth(ram_payer);
+
+                check(is_account(owner), "owner account does not exist");
+
+                auto sym_code_raw = symbol.code().raw();
+                Stats statstable(_self, sym_code_raw);
+                const auto& st = statstable.get(sym_code_raw, "symbol does not exist");
+                check(st.supply.symbol == symbol, "symbol precision mismatch");
+
+                Accounts acnts(_self, owner.value);
+                auto it = acnts.find(sym_code_raw);
+                if (it == acnts.end()) {
+                    acnts.emplace(ram_payer, [&](auto& a){
+                        a.balance = asset{0, symbol};
+                    });
+                }
+            }
+
+            void close(const name& owner, const symbol& symbol) {
+                require_auth(owner);
+                Accounts acnts(_self, owner.value);
+                auto it = acnts.find(symbol.code().raw());
+                check(it != acnts.end(), "Balance row already deleted or never existed. Action won't have any effect.");
+                check(it->balance.amount == 0, "Cannot close because the balance is not zero.");
+                acnts.erase(it);
+
+                if constexpr (Lock::enabled) {
+                    _lock.on_close(owner, symbol.code());
+                }
+            }
+
+        private:
+            name _self;
+            Lock _lock;
+
+            // `any_recipient` issues credit any account, plain issues only the issuer
+            void mint(const name& to, const asset& quantity, std::string_view memo, bool any_recipient) {
+                auto sym = quantity.symbol;
+                check(sym.is_valid(), "invalid symbol name");
+                check(memo.size() <= 256, "memo has more than 256 bytes");
+
+                Stats statstable(_self, sym.code().raw());
+                auto existing = statstable.find(sym.code().raw());
+                check(existing != statstable.end(), "token with symbol does not exist, create token before issue");
+                const auto& st = *existing;
+                if (any_recipient) {
+                    check(is_account(to), "to account does not exist");
+                } else {
+                    check(to == st.issuer, "tokens can only be issued to issuer account");
+                }
+
+                require_auth(st.issuer);
+                check(quantity.is_valid(), "invalid quantity");
+                check(quantity.amount > 0, "must issue positive quantity");
+
+                check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
+                check(quantity.amount <= st.max_supply.amount - st.supply.amount, "quantity exceeds available supply");
+                IssueCap::check_issue(st.supply, quantity);
+
+                statstable.modify(st, same_payer, [&](auto& s) {
+                    s.supply += quantity;
+                });
+
+                add_balance(to, quantity, st.issuer);
+                if (to != st.issuer) {
+                    require_recipient(to);
+                    if constexpr (Lock::enabled) {
+                        _lock.on_receive(to, quantity, st.issuer, st);
+                    }
+                }
+            }
+
+            // `spend` debits go through the lock policy, retire and issuer debits do not
+            void sub_balance(const name& owner, const asset& value, bool spend, const name& ram_payer) {
+                Accounts from_acnts(_self, owner.value);
+
+                const auto& from = from_acnts.get(value.symbol.code().raw(), "no balance object found");
+                check(from.balance.amount >= value.amount, "overdrawn balance");
+                if constexpr (Lock::enabled) {
+                    check(!spend || _lock.can_spend(owner, from.balance - value), "transfer amount is greater than locked");
+                }
+
+                from_acnts.modify(from, ram_payer, [&](auto& a) {
+                    a.balance -= value;
+                });
+            }
+
+            void add_balance(const name& owner, const asset& value, const name& ram_payer) {
+                Accounts to_acnts(_self, owner.value);
+                auto to = to_acnts.find(value.symbol.code().raw());
+                if (to == to_acnts.end()) {
+                    to_acnts.emplace(ram_payer, [&](auto& a){
+                        a.balance = value;
+                    });
+                } else {
+                    to_acnts.modify(to, same_payer, [&](auto& a) {
+                        a.balance += value;
+                    });
+                }
+            }
+    };
+
+}
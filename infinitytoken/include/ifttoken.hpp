@@ -4,13 +4,23 @@
 #include <eosio/eosio.hpp>
 #include <eosio/system.hpp>
 
+#include <actiondata.hpp>
+#include <tokencore.hpp>
+
 #include <string>
+#include <vector>
 
 using namespace eosio;
 using std::string;
 using std::map;
 
 // token.ift
+struct transfer_entry {
+    name     to;
+    int64_t  amount;
+    string   memo;
+};
+
 class [[eosio::contract("ifttoken")]] ifttoken : public contract {
     public:
         using contract::contract;
@@ -37,6 +47,16 @@ class [[eosio::contract("ifttoken")]] ifttoken : public contract {
          */
         [[eosio::action]]
         void issue(const name& to, const asset& quantity, const string& memo);
+        /**
+         * Issues `quantity` straight into `to`'s balance, the same as `issue` followed by a
+         * transfer from the issuer, in one action.
+         *
+         * @param to - the account to issue tokens to,
+         * @param quantity - the amount of tokens to be issued,
+         * @param memo - the memo string that accompanies the token issue transaction.
+         */
+        [[eosio::action]]
+        void issueto(const name& to, const asset& quantity, const string& memo);
 
         /**
          * The opposite for create action, if all validations succeed,
@@ -59,6 +79,19 @@ class [[eosio::contract("ifttoken")]] ifttoken : public contract {
          */
         [[eosio::action]]
         void transfer(const name&    from,  const name&    to, const asset&   quantity, const string&  memo);
+
+        /**
+         * Allows `from` account to transfer `sym` tokens to every recipient of `transfers` in one action.
+         * The symbol is checked and `from` is debited once for the total.
+         * Recipients are notified of `transfers`, not `transfer`, so contracts that act on incoming
+         * transfers must still be sent a `transfer`.
+         *
+         * @param from - the account to transfer from,
+         * @param sym - the symbol of the tokens to be transferred,
+         * @param transfers - the recipients, each with its amount and memo.
+         */
+        [[eosio::action]]
+        void transfers(const name& from, const symbol& sym, const std::vector<transfer_entry>& transfers);
         /**
          * Allows `ram_payer` to create an account `owner` with zero balance for
          * token `symbol` at the expense of `ram_payer`.
@@ -87,6 +120,9 @@ class [[eosio::contract("ifttoken")]] ifttoken : public contract {
         void close(const name& owner, const symbol& symbol );
 
 
+        // the contract's apply, transfer, issue, issueto and retire are decoded in place with the memo as a view
+        static void dispatch(uint64_t receiver, uint64_t code, uint64_t action);
+
         static asset get_supply(const name& token_contract_account, const symbol_code& sym_code) {
             stats statstable( token_contract_account, sym_code.raw() );
             const auto& st = statstable.get( sym_code.raw() );
@@ -116,7 +152,9 @@ class [[eosio::contract("ifttoken")]] ifttoken : public contract {
         typedef eosio::multi_index< "accounts"_n, account > accounts;
         typedef eosio::multi_index< "stat"_n, currency_stats > stats;
 
-        void sub_balance(const name& owner, const asset& value);
-        const asset& add_balance(const name& owner, const asset& value, const name& ram_payer);
+        // issue is capped at 1% of the supply, balances are never locked
+        typedef tokencore::basic_token<accounts, stats, tokencore::issue_cap<100>, tokencore::no_lock> token_core;
+
+        token_core core() { return token_core(get_self()); }
 
 };
@@ -1,153 +1,70 @@
 #include <ifttoken.hpp>
 
 void ifttoken::create(const name&   issuer, const asset&  maximum_supply) {
-    require_auth(get_self());
-
-    auto sym = maximum_supply.symbol;
-    check(sym.is_valid(), "invalid symbol name");
-    check(maximum_supply.is_valid(), "invalid supply");
-    check(maximum_supply.amount > 0, "max-supply must be positive");
-
-    stats statstable(get_self(), sym.code().raw());
-    auto existing = statstable.find(sym.code().raw());
-    check(existing == statstable.end(), "token with symbol already exists");
-
-    statstable.emplace(get_self(), [&](auto& s) {
-        s.supply.symbol = maximum_supply.symbol;
-        s.max_supply    = maximum_supply;
-        s.issuer        = issuer;
-    });
+    core().create(issuer, maximum_supply);
 }
 
-
 void ifttoken::issue(const name& to, const asset& quantity, const string& memo) {
-    auto sym = quantity.symbol;
-    check(sym.is_valid(), "invalid symbol name");
-    check(memo.size() <= 256, "memo has more than 256 bytes");
-
-    stats statstable(get_self(), sym.code().raw());
-    auto existing = statstable.find(sym.code().raw());
-    check(existing != statstable.end(), "token with symbol does not exist, create token before issue");
-    const auto& st = *existing;
-    check(to == st.issuer, "tokens can only be issued to issuer account");
-
-    require_auth(st.issuer);
-    check(quantity.is_valid(), "invalid quantity");
-    check(quantity.amount > 0, "must issue positive quantity");
-
-    check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
-    check(quantity.amount <= st.max_supply.amount - st.supply.amount, "quantity exceeds available supply");
-
-    if (st.supply.amount > 0) {
-        // It is not allowed to issue more than 1% tokens at one time
-        auto max_amount = st.supply.amount / 100;
-        check(quantity.amount <= max_amount, "issue quantity too much");
-    }
-
-    statstable.modify(st, same_payer, [&](auto& s) {
-        s.supply += quantity;
-    });
+    core().issue(to, quantity, memo);
+}
 
-    add_balance(st.issuer, quantity, st.issuer);
+void ifttoken::issueto(const name& to, const asset& quantity, const string& memo) {
+    core().issueto(to, quantity, memo);
 }
 
 void ifttoken::retire(const asset& quantity, const string& memo) {
-    auto sym = quantity.symbol;
-    check(sym.is_valid(), "invalid symbol name");
-    check(memo.size() <= 256, "memo has more than 256 bytes");
-
-    stats statstable(get_self(), sym.code().raw());
-    auto existing = statstable.find(sym.code().raw());
-    check(existing != statstable.end(), "token with symbol does not exist");
-    const auto& st = *existing;
-
-    require_auth(st.issuer);
-    check(quantity.is_valid(), "invalid quantity");
-    check(quantity.amount > 0, "must retire positive quantity");
-
-    check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
-
-    statstable.modify(st, same_payer, [&](auto& s) {
-        s.supply -= quantity;
-    });
-
-    sub_balance(st.issuer, quantity);
+    core().retire(quantity, memo);
 }
 
 void ifttoken::transfer(const name&    from, const name&    to, const asset&   quantity, const string&  memo) {
-    check(from != to, "cannot transfer to self");
-    require_auth(from);
-    check(is_account(to), "to account does not exist");
-    auto sym = quantity.symbol.code();
-    stats statstable(get_self(), sym.raw());
-    const auto& st = statstable.get(sym.raw());
-
-    require_recipient(from);
-    require_recipient(to);
-
-    check(quantity.is_valid(), "invalid quantity");
-    check(quantity.amount > 0, "must transfer positive quantity");
-    check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
-    check(memo.size() <= 256, "memo has more than 256 bytes");
-
-    auto payer = has_auth(to) ? to : from;
-
-    sub_balance(from, quantity);
-    add_balance(to, quantity, payer);
+    core().transfer(from, to, quantity, memo);
 }
 
-void ifttoken::sub_balance(const name& owner, const asset& value) {
-    accounts from_acnts(get_self(), owner.value);
-
-    const auto& from = from_acnts.get(value.symbol.code().raw(), "no balance object found");
-    check(from.balance.amount >= value.amount, "overdrawn balance");
-
-    from_acnts.modify(from, owner, [&](auto& a) {
-        a.balance -= value;
-    });
-}
-
-const asset& ifttoken::add_balance(const name& owner, const asset& value, const name& ram_payer) {
-    accounts to_acnts(get_self(), owner.value);
-    auto to = to_acnts.find(value.symbol.code().raw());
-    if (to == to_acnts.end()) {
-        to = to_acnts.emplace(ram_payer, [&](auto& a){
-            a.balance = value;
-        });
-    } else {
-        to_acnts.modify(to, same_payer, [&](auto& a) {
-            a.balance += value;
-        });
-    }
-    
-    return to->balance;
+void ifttoken::transfers(const name& from, const symbol& sym, const std::vector<transfer_entry>& transfers) {
+    core().transfers(from, sym, transfers);
 }
 
 void ifttoken::open(const name& owner, const symbol& symbol, const name& ram_payer) {
-    require_auth(ram_payer);
-
-    check(is_account(owner ), "owner account does not exist");
+    core().open(owner, symbol, ram_payer);
+}
 
-    auto sym_code_raw = symbol.code().raw();
-    stats statstable(get_self(), sym_code_raw);
-    const auto& st = statstable.get(sym_code_raw, "symbol does not exist");
-    check(st.supply.symbol == symbol, "symbol precision mismatch");
+void ifttoken::close(const name& owner, const symbol& symbol) {
+    core().close(owner, symbol);
+}
 
-    accounts acnts(get_self(), owner.value);
-    auto it = acnts.find(sym_code_raw);
-    if (it == acnts.end()) {
-        acnts.emplace(ram_payer, [&](auto& a){
-            a.balance = asset{0, symbol};
-        });
+void ifttoken::dispatch(uint64_t receiver, uint64_t code, uint64_t action) {
+    if (code != receiver) {
+        return;
+    }
+    if (action == "transfer"_n.value || action == "issue"_n.value || action == "issueto"_n.value || action == "retire"_n.value) {
+        actiondata::reader<actiondata::MAX_MEMO_ACTION_SIZE> data;
+        name from, to;
+        asset quantity;
+        std::string_view memo;
+        if (action == "transfer"_n.value && data.read(from, to, quantity, memo)) {
+            ifttoken(name(receiver), name(code), data.stream()).core().transfer(from, to, quantity, memo);
+            return;
+        }
+        if (action == "issue"_n.value && data.read(to, quantity, memo)) {
+            ifttoken(name(receiver), name(code), data.stream()).core().issue(to, quantity, memo);
+            return;
+        }
+        if (action == "issueto"_n.value && data.read(to, quantity, memo)) {
+            ifttoken(name(receiver), name(code), data.stream()).core().issueto(to, quantity, memo);
+            return;
+        }
+        if (action == "retire"_n.value && data.read(quantity, memo)) {
+            ifttoken(name(receiver), name(code), data.stream()).core().retire(quantity, memo);
+            return;
+        }
+    }
+    switch (action) {
+        EOSIO_DISPATCH_HELPER(ifttoken, (create)(issue)(issueto)(retire)(transfer)(transfers)(open)(close))
     }
 }
 
-void ifttoken::close(const name& owner, const symbol& symbol) {
-    require_auth(owner);
-    accounts acnts(get_self(), owner.value);
-    auto it = acnts.find(symbol.code().raw());
-    check(it != acnts.end(), "Balance row already deleted or never existed. Action won't have any effect.");
-    check(it->balance.amount == 0, "Cannot close because the balance is not zero.");
-    acnts.erase(it);
+extern "C" {
+    void apply(uint64_t receiver, uint64_t code, uint64_t action) {
+        ifttoken::dispatch(receiver, code, action);
+    }
 }
-
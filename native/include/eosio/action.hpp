@@ -0,0 +1,108 @@
+#pragma once
+
+#include <eosio/datastream.hpp>
+#include <eosio/name.hpp>
+#include <eosio/native/intrinsics.hpp>
+
+#include <vector>
+
+namespace eosio {
+
+    inline uint32_t read_action_data(void* msg, uint32_t len) {
+        return internal_use_do_not_use::read_action_data(msg, len);
+    }
+
+    inline uint32_t action_data_size() {
+        return internal_use_do_not_use::action_data_size();
+    }
+
+    template <typename T>
+    T unpack_action_data() {
+        std::vector<char> buffer(action_data_size());
+        read_action_data(buffer.data(), buffer.size());
+        return unpack<T>(buffer);
+    }
+
+    inline void require_recipient(name notify_account) {
+        internal_use_do_not_use::require_recipient(notify_account.value);
+    }
+
+    template <typename... accounts>
+    void require_recipient(name notify_account, accounts... remaining_accounts) {
+        internal_use_do_not_use::require_recipient(notify_account.value);
+        require_recipient(remaining_accounts...);
+    }
+
+    inline void require_auth(name n) {
+        internal_use_do_not_use::require_auth(n.value);
+    }
+
+    inline bool has_auth(name n) {
+        return internal_use_do_not_use::has_auth(n.value);
+    }
+
+    inline bool is_account(name n) {
+        return internal_use_do_not_use::is_account(n.value);
+    }
+
+    inline void set_action_return_value(void* return_value, size_t size) {
+        internal_use_do_not_use::set_action_return_value(return_value, size);
+    }
+
+    struct permission_level {
+        constexpr permission_level(name a, name p) : actor(a), permission(p) {}
+        constexpr permission_level() {}
+
+        name actor;
+        name permission;
+
+        friend constexpr bool operator==(const permission_level& a, const permission_level& b) {
+            return a.actor == b.actor && a.permission == b.permission;
+        }
+        friend constexpr bool operator<(const permission_level& a, const permission_level& b) {
+            return a.actor < b.actor || (a.actor == b.actor && a.permission < b.permission);
+        }
+    };
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const permission_level& v) { return ds << v.actor << v.permission; }
+    template <typename DS>
+    DS& operator>>(DS& ds, permission_level& v) { return ds >> v.actor >> v.permission; }
+
+    inline void require_auth(const permission_level& level) {
+        internal_use_do_not_use::require_auth2(level.actor.value, level.permission.value);
+    }
+
+    struct action {
+        eosio::name account;
+        eosio::name name;
+        std::vector<permission_level> authorization;
+        std::vector<char> data;
+
+        action() = default;
+
+        template <typename T>
+        action(const permission_level& auth, struct name a, struct name n, T&& value)
+            : account(a), name(n), authorization(1, auth), data(pack(std::forward<T>(value))) {}
+
+        template <typename T>
+        action(std::vector<permission_level> auths, struct name a, struct name n, T&& value)
+            : account(a), name(n), authorization(std::move(auths)), data(pack(std::forward<T>(value))) {}
+
+        void send() const {
+            auto serialize = pack(*this);
+            internal_use_do_not_use::send_inline(serialize.data(), serialize.size());
+        }
+
+        template <typename T>
+        T data_as() const {
+            return unpack<T>(data);
+        }
+    };
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const action& v) { return ds << v.account << v.name << v.authorization << v.data; }
+    template <typename DS>
+    DS& operator>>(DS& ds, action& v) { return ds >> v.account >> v.name >> v.authorization >> v.data; }
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <eosio/symbol.hpp>
+
+#include <limits>
+#include <string>
+
+namespace eosio {
+
+    struct asset {
+        static constexpr int64_t max_amount = (1LL << 62) - 1;
+
+        int64_t amount = 0;
+        eosio::symbol symbol;
+
+        asset() {}
+        asset(int64_t a, class symbol s) : amount(a), symbol(s) {
+            check(is_amount_within_range(), "magnitude of asset amount must be less than 2^62");
+            check(symbol.is_valid(), "invalid symbol name");
+        }
+
+        bool is_amount_within_range() const { return -max_amount <= amount && amount <= max_amount; }
+        bool is_valid() const { return is_amount_within_range() && symbol.is_valid(); }
+
+        void set_amount(int64_t a) {
+            amount = a;
+            check(is_amount_within_range(), "magnitude of asset amount must be less than 2^62");
+        }
+
+        asset operator-() const {
+            asset r = *this;
+            r.amount = -r.amount;
+            return r;
+        }
+
+        asset& operator-=(const asset& a) {
+            check(a.symbol == symbol, "attempt to subtract asset with different symbol");
+            amount -= a.amount;
+            check(-max_amount <= amount, "subtraction underflow");
+            check(amount <= max_amount, "subtraction overflow");
+            return *this;
+        }
+
+        asset& operator+=(const asset& a) {
+            check(a.symbol == symbol, "attempt to add asset with different symbol");
+            amount += a.amount;
+            check(-max_amount <= amount, "addition underflow");
+            check(amount <= max_amount, "addition overflow");
+            return *this;
+        }
+
+        friend asset operator+(const asset& a, const asset& b) {
+            asset result = a;
+            result += b;
+            return result;
+        }
+
+        friend asset operator-(const asset& a, const asset& b) {
+            asset result = a;
+            result -= b;
+            return result;
+        }
+
+        asset& operator*=(int64_t a) {
+            int128_t tmp = (int128_t)amount * (int128_t)a;
+            check(tmp <= max_amount, "multiplication overflow");
+            check(tmp >= -max_amount, "multiplication underflow");
+            amount = (int64_t)tmp;
+            return *this;
+        }
+
+        friend asset operator*(const asset& a, int64_t b) {
+            asset result = a;
+            result *= b;
+            return result;
+        }
+
+        asset& operator/=(int64_t a) {
+            check(a != 0, "divide by zero");
+            check(!(amount == std::numeric_limits<int64_t>::min() && a == -1), "signed division overflow");
+            amount /= a;
+            return *this;
+        }
+
+        friend asset operator/(const asset& a, int64_t b) {
+            asset result = a;
+            result /= b;
+            return result;
+        }
+
+        friend bool operator==(const asset& a, const asset& b) {
+            check(a.symbol == b.symbol, "comparison of assets with different symbols is not allowed");
+            return a.amount == b.amount;
+        }
+        friend bool operator!=(const asset& a, const asset& b) { return !(a == b); }
+        friend bool operator<(const asset& a, const asset& b) {
+            check(a.symbol == b.symbol, "comparison of assets with different symbols is not allowed");
+            return a.amount < b.amount;
+        }
+        friend bool operator<=(const asset& a, const asset& b) { return !(b < a); }
+        friend bool operator>(const asset& a, const asset& b) { return b < a; }
+        friend bool operator>=(const asset& a, const asset& b) { return !(a < b); }
+
+        std::string to_string() const {
+            auto p = symbol.precision();
+            bool negative = amount < 0;
+            uint64_t invert = negative ? uint64_t(-(amount + 1)) + 1 : uint64_t(amount);
+            std::string digits = std::to_string(invert);
+            if (p > 0) {
+                if (digits.size() <= p) {
+                    digits.insert(0, p + 1 - digits.size(), '0');
+                }
+                digits.insert(digits.size() - p, 1, '.');
+            }
+            return (negative ? "-" : "") + digits + " " + symbol.code().to_string();
+        }
+
+        void print() const { native::print_console(to_string()); }
+    };
+
+    struct extended_asset {
+        asset quantity;
+        name contract;
+    };
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+typedef unsigned __int128 uint128_t;
+typedef __int128 int128_t;
+
+namespace eosio {
+
+    /**
+     * Thrown by `check` when an assertion fails. The native chain catches it at
+     * the transaction boundary and rolls back every table write, like nodeos does.
+     */
+    struct eosio_assert_failure : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    inline void check(bool pred, const char* msg) {
+        if (!pred) {
+            throw eosio_assert_failure(msg);
+        }
+    }
+
+    inline void check(bool pred, const std::string& msg) {
+        if (!pred) {
+            throw eosio_assert_failure(msg);
+        }
+    }
+
+    inline void check(bool pred, const char* msg, size_t n) {
+        if (!pred) {
+            throw eosio_assert_failure(std::string(msg, n));
+        }
+    }
+
+    inline void check(bool pred, uint64_t code) {
+        if (!pred) {
+            throw eosio_assert_failure("assertion failure with error code: " + std::to_string(code));
+        }
+    }
+
+    namespace native {
+        void print_console(std::string_view s);
+    }
+
+    inline void printui(uint64_t v) { native::print_console(std::to_string(v)); }
+    inline void printi(int64_t v) { native::print_console(std::to_string(v)); }
+    inline void prints(const char* s) { native::print_console(s); }
+
+    template <typename T>
+    void print(const T& v) {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            native::print_console(std::string_view(v));
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            native::print_console(std::to_string(v));
+        } else {
+            v.print();
+        }
+    }
+
+    template <typename T, typename... Ts>
+    void print(const T& v, const Ts&... vs) {
+        print(v);
+        (print(vs), ...);
+    }
+
+}
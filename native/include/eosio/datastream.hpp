@@ -0,0 +1,541 @@
+#pragma once
+
+#include <eosio/asset.hpp>
+#include <eosio/name.hpp>
+#include <eosio/symbol.hpp>
+#include <eosio/time.hpp>
+
+#include <array>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace eosio {
+
+    /**
+     * Byte stream over a caller-owned buffer. `datastream<size_t>` only counts bytes,
+     * which is how `pack_size` measures a value without writing it.
+     */
+    template <typename T>
+    class datastream {
+        public:
+            datastream(T start, size_t s) : _start(start), _pos(start), _end(start + s) {}
+
+            void skip(size_t s) { _pos += s; }
+
+            bool read(void* d, size_t s) {
+                check(size_t(_end - _pos) >= s, "datastream attempted to read past the end");
+                std::memcpy(d, _pos, s);
+                _pos += s;
+                return true;
+            }
+
+            bool write(const void* d, size_t s) {
+                check(_end - _pos >= (int32_t)s, "datastream attempted to write past the end");
+                std::memcpy((void*)_pos, d, s);
+                _pos += s;
+                return true;
+            }
+
+            bool write(char d) { return write(&d, 1); }
+
+            T pos() const { return _pos; }
+            bool valid() const { return _pos <= _end && _pos >= _start; }
+            bool seekp(size_t p) { _pos = _start + p; return _pos <= _end; }
+            size_t tellp() const { return size_t(_pos - _start); }
+            size_t remaining() const { return _end - _pos; }
+
+        private:
+            T _start;
+            T _pos;
+            T _end;
+    };
+
+    template <>
+    class datastream<size_t> {
+        public:
+            datastream(size_t init_size = 0) : _size(init_size) {}
+            bool skip(size_t s) { _size += s; return true; }
+            bool write(const void*, size_t s) { _size += s; return true; }
+            bool write(char) { _size++; return true; }
+            bool valid() const { return true; }
+            bool seekp(size_t p) { _size = p; return true; }
+            size_t tellp() const { return _size; }
+            size_t remaining() const { return 0; }
+
+        private:
+            size_t _size;
+    };
+
+    struct unsigned_int {
+        unsigned_int(uint32_t v = 0) : value(v) {}
+        operator uint32_t() const { return value; }
+        uint32_t value;
+    };
+
+    /**
+     * Field appended to a table or action after deployment. Old rows simply end before it,
+     * so deserialization leaves it empty instead of failing.
+     */
+    template <typename T>
+    class binary_extension {
+        public:
+            using value_type = T;
+
+            constexpr binary_extension() {}
+            constexpr binary_extension(const T& v) : _value(v) {}
+            constexpr binary_extension(T&& v) : _value(std::move(v)) {}
+
+            constexpr bool has_value() const { return _value.has_value(); }
+            constexpr explicit operator bool() const { return has_value(); }
+
+            constexpr T& value() & {
+                check(has_value(), "cannot get value of empty binary_extension");
+                return *_value;
+            }
+            constexpr const T& value() const& {
+                check(has_value(), "cannot get value of empty binary_extension");
+                return *_value;
+            }
+            constexpr T value_or(const T& def = {}) const { return _value.value_or(def); }
+
+            constexpr T& operator*() & { return value(); }
+            constexpr const T& operator*() const& { return value(); }
+            constexpr T* operator->() { return &value(); }
+            constexpr const T* operator->() const { return &value(); }
+
+            template <typename... Args>
+            T& emplace(Args&&... args) {
+                _value.emplace(std::forward<Args>(args)...);
+                return *_value;
+            }
+
+            void reset() { _value.reset(); }
+
+        private:
+            std::optional<T> _value;
+    };
+
+    namespace detail {
+        template <typename T>
+        struct is_datastream : std::false_type {};
+        template <typename T>
+        struct is_datastream<datastream<T>> : std::true_type {};
+
+        // Aggregate reflection: the CDT serializes table and action structs without
+        // EOSLIB_SERIALIZE, so the stand-in has to discover their fields the same way.
+        struct any_field {
+            template <typename T>
+            operator T() const;
+        };
+
+        template <typename T, size_t... I>
+        constexpr bool brace_constructible(std::index_sequence<I...>) {
+            return requires { T { ((void)I, any_field {})... }; };
+        }
+
+        template <typename T, size_t N = 0>
+        constexpr size_t field_count() {
+            if constexpr (N < 16 && brace_constructible<T>(std::make_index_sequence<N + 1> {})) {
+                return field_count<T, N + 1>();
+            } else {
+                return N;
+            }
+        }
+
+        template <typename T, typename F>
+        void for_each_field(T& v, F&& f) {
+            constexpr size_t n = field_count<std::remove_const_t<T>>();
+            static_assert(n > 0 || std::is_empty_v<std::remove_const_t<T>>, "unable to reflect the fields of this struct");
+            static_assert(n < 16, "reflected structs are limited to 15 fields");
+            if constexpr (n == 0) {
+            } else if constexpr (n == 1) {
+                auto& [a] = v; f(a);
+            } else if constexpr (n == 2) {
+                auto& [a, b] = v; f(a); f(b);
+            } else if constexpr (n == 3) {
+                auto& [a, b, c] = v; f(a); f(b); f(c);
+            } else if constexpr (n == 4) {
+                auto& [a, b, c, d] = v; f(a); f(b); f(c); f(d);
+            } else if constexpr (n == 5) {
+                auto& [a, b, c, d, e] = v; f(a); f(b); f(c); f(d); f(e);
+            } else if constexpr (n == 6) {
+                auto& [a, b, c, d, e, g] = v; f(a); f(b); f(c); f(d); f(e); f(g);
+            } else if constexpr (n == 7) {
+                auto& [a, b, c, d, e, g, h] = v; f(a); f(b); f(c); f(d); f(e); f(g); f(h);
+            } else if constexpr (n == 8) {
+                auto& [a, b, c, d, e, g, h, i] = v; f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i);
+            } else if constexpr (n == 9) {
+                auto& [a, b, c, d, e, g, h, i, j] = v; f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i); f(j);
+            } else if constexpr (n == 10) {
+                auto& [a, b, c, d, e, g, h, i, j, k] = v; f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i); f(j); f(k);
+            } else if constexpr (n == 11) {
+                auto& [a, b, c, d, e, g, h, i, j, k, l] = v;
+                f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i); f(j); f(k); f(l);
+            } else if constexpr (n == 12) {
+                auto& [a, b, c, d, e, g, h, i, j, k, l, m] = v;
+                f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i); f(j); f(k); f(l); f(m);
+            } else if constexpr (n == 13) {
+                auto& [a, b, c, d, e, g, h, i, j, k, l, m, o] = v;
+                f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i); f(j); f(k); f(l); f(m); f(o);
+            } else if constexpr (n == 14) {
+                auto& [a, b, c, d, e, g, h, i, j, k, l, m, o, p] = v;
+                f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i); f(j); f(k); f(l); f(m); f(o); f(p);
+            } else if constexpr (n == 15) {
+                auto& [a, b, c, d, e, g, h, i, j, k, l, m, o, p, q] = v;
+                f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i); f(j); f(k); f(l); f(m); f(o); f(p); f(q);
+            } else {
+                auto& [a, b, c, d, e, g, h, i, j, k, l, m, o, p, q, r] = v;
+                f(a); f(b); f(c); f(d); f(e); f(g); f(h); f(i); f(j); f(k); f(l); f(m); f(o); f(p); f(q); f(r);
+            }
+        }
+
+        template <typename T>
+        concept reflected_struct = std::is_class_v<T> && std::is_aggregate_v<T>;
+    }
+
+    // fundamentals
+
+    template <typename DS, typename T>
+        requires (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+    DS& operator<<(DS& ds, const T& v) {
+        ds.write((const char*)&v, sizeof(T));
+        return ds;
+    }
+
+    template <typename DS, typename T>
+        requires (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+    DS& operator>>(DS& ds, T& v) {
+        ds.read((char*)&v, sizeof(T));
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const bool& v) {
+        uint8_t b = v ? 1 : 0;
+        ds.write((const char*)&b, 1);
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator>>(DS& ds, bool& v) {
+        uint8_t b = 0;
+        ds.read((char*)&b, 1);
+        v = b != 0;
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const uint128_t& v) {
+        ds.write((const char*)&v, sizeof(v));
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator>>(DS& ds, uint128_t& v) {
+        ds.read((char*)&v, sizeof(v));
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const int128_t& v) {
+        ds.write((const char*)&v, sizeof(v));
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator>>(DS& ds, int128_t& v) {
+        ds.read((char*)&v, sizeof(v));
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const unsigned_int& v) {
+        uint64_t val = v.value;
+        do {
+            uint8_t b = uint8_t(val) & 0x7f;
+            val >>= 7;
+            b |= ((val > 0) << 7);
+            ds.write((char*)&b, 1);
+        } while (val);
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator>>(DS& ds, unsigned_int& vi) {
+        uint64_t v = 0;
+        char b = 0;
+        uint8_t by = 0;
+        do {
+            ds.read(&b, 1);
+            v |= uint32_t(uint8_t(b) & 0x7f) << by;
+            by += 7;
+        } while (uint8_t(b) & 0x80 && by < 32);
+        vi.value = static_cast<uint32_t>(v);
+        return ds;
+    }
+
+    // chain types
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const name& v) { return ds << v.value; }
+    template <typename DS>
+    DS& operator>>(DS& ds, name& v) { return ds >> v.value; }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const symbol_code& v) { return ds << v.raw(); }
+    template <typename DS>
+    DS& operator>>(DS& ds, symbol_code& v) {
+        uint64_t raw = 0;
+        ds >> raw;
+        v = symbol_code(raw);
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const symbol& v) { return ds << v.raw(); }
+    template <typename DS>
+    DS& operator>>(DS& ds, symbol& v) {
+        uint64_t raw = 0;
+        ds >> raw;
+        v = symbol(raw);
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const asset& v) { return ds << v.amount << v.symbol; }
+    template <typename DS>
+    DS& operator>>(DS& ds, asset& v) { return ds >> v.amount >> v.symbol; }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const microseconds& v) { return ds << v._count; }
+    template <typename DS>
+    DS& operator>>(DS& ds, microseconds& v) { return ds >> v._count; }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const time_point& v) { return ds << v.elapsed; }
+    template <typename DS>
+    DS& operator>>(DS& ds, time_point& v) { return ds >> v.elapsed; }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const time_point_sec& v) { return ds << v.utc_seconds; }
+    template <typename DS>
+    DS& operator>>(DS& ds, time_point_sec& v) { return ds >> v.utc_seconds; }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const block_timestamp& v) { return ds << v.slot; }
+    template <typename DS>
+    DS& operator>>(DS& ds, block_timestamp& v) { return ds >> v.slot; }
+
+    template <typename DS, typename T>
+    DS& operator<<(DS& ds, const binary_extension<T>& v) {
+        if (v.has_value()) {
+            ds << *v;
+        }
+        return ds;
+    }
+
+    template <typename DS, typename T>
+    DS& operator>>(DS& ds, binary_extension<T>& v) {
+        if (ds.remaining()) {
+            T tmp;
+            ds >> tmp;
+            v.emplace(std::move(tmp));
+        }
+        return ds;
+    }
+
+    // containers
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const std::string& v) {
+        ds << unsigned_int(uint32_t(v.size()));
+        if (v.size()) {
+            ds.write(v.data(), v.size());
+        }
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator>>(DS& ds, std::string& v) {
+        unsigned_int s;
+        ds >> s;
+        v.resize(s.value);
+        if (s.value) {
+            ds.read(v.data(), s.value);
+        }
+        return ds;
+    }
+
+    template <typename DS>
+    DS& operator<<(DS& ds, const std::string_view& v) {
+        ds << unsigned_int(uint32_t(v.size()));
+        if (v.size()) {
+            ds.write(v.data(), v.size());
+        }
+        return ds;
+    }
+
+    template <typename DS, typename T>
+    DS& operator<<(DS& ds, const std::vector<T>& v) {
+        ds << unsigned_int(uint32_t(v.size()));
+        if constexpr (std::is_same_v<T, char> || std::is_same_v<T, uint8_t>) {
+            if (v.size()) {
+                ds.write((const char*)v.data(), v.size());
+            }
+        } else {
+            for (const auto& i : v) {
+                ds << i;
+            }
+        }
+        return ds;
+    }
+
+    template <typename DS, typename T>
+    DS& operator>>(DS& ds, std::vector<T>& v) {
+        unsigned_int s;
+        ds >> s;
+        v.resize(s.value);
+        if constexpr (std::is_same_v<T, char> || std::is_same_v<T, uint8_t>) {
+            if (s.value) {
+                ds.read((char*)v.data(), s.value);
+            }
+        } else {
+            for (auto& i : v) {
+                ds >> i;
+            }
+        }
+        return ds;
+    }
+
+    template <typename DS, typename T, size_t N>
+    DS& operator<<(DS& ds, const std::array<T, N>& v) {
+        for (const auto& i : v) {
+            ds << i;
+        }
+        return ds;
+    }
+
+    template <typename DS, typename T, size_t N>
+    DS& operator>>(DS& ds, std::array<T, N>& v) {
+        for (auto& i : v) {
+            ds >> i;
+        }
+        return ds;
+    }
+
+    template <typename DS, typename T>
+    DS& operator<<(DS& ds, const std::optional<T>& v) {
+        ds << bool(v.has_value());
+        if (v) {
+            ds << *v;
+        }
+        return ds;
+    }
+
+    template <typename DS, typename T>
+    DS& operator>>(DS& ds, std::optional<T>& v) {
+        bool valid = false;
+        ds >> valid;
+        if (valid) {
+            T tmp;
+            ds >> tmp;
+            v.emplace(std::move(tmp));
+        } else {
+            v.reset();
+        }
+        return ds;
+    }
+
+    template <typename DS, typename K, typename V>
+    DS& operator<<(DS& ds, const std::pair<K, V>& v) { return ds << v.first << v.second; }
+    template <typename DS, typename K, typename V>
+    DS& operator>>(DS& ds, std::pair<K, V>& v) { return ds >> v.first >> v.second; }
+
+    template <typename DS, typename K, typename V>
+    DS& operator<<(DS& ds, const std::map<K, V>& m) {
+        ds << unsigned_int(uint32_t(m.size()));
+        for (const auto& i : m) {
+            ds << i.first << i.second;
+        }
+        return ds;
+    }
+
+    template <typename DS, typename K, typename V>
+    DS& operator>>(DS& ds, std::map<K, V>& m) {
+        m.clear();
+        unsigned_int s;
+        ds >> s;
+        for (uint32_t i = 0; i < s.value; ++i) {
+            K k;
+            V v;
+            ds >> k >> v;
+            m.emplace(std::move(k), std::move(v));
+        }
+        return ds;
+    }
+
+    template <typename DS, typename... Args>
+    DS& operator<<(DS& ds, const std::tuple<Args...>& t) {
+        std::apply([&](const auto&... args) { (void)(ds << ... << args); }, t);
+        return ds;
+    }
+
+    template <typename DS, typename... Args>
+    DS& operator>>(DS& ds, std::tuple<Args...>& t) {
+        std::apply([&](auto&... args) { (void)(ds >> ... >> args); }, t);
+        return ds;
+    }
+
+    // reflected structs
+
+    template <typename DS, typename T>
+        requires (detail::reflected_struct<T> && !std::is_array_v<T>)
+    DS& operator<<(DS& ds, const T& v) {
+        detail::for_each_field(v, [&](const auto& field) { ds << field; });
+        return ds;
+    }
+
+    template <typename DS, typename T>
+        requires (detail::reflected_struct<T> && !std::is_array_v<T>)
+    DS& operator>>(DS& ds, T& v) {
+        detail::for_each_field(v, [&](auto& field) { ds >> field; });
+        return ds;
+    }
+
+    template <typename T>
+    size_t pack_size(const T& value) {
+        datastream<size_t> ps;
+        ps << value;
+        return ps.tellp();
+    }
+
+    template <typename T>
+    std::vector<char> pack(const T& value) {
+        std::vector<char> result;
+        result.resize(pack_size(value));
+        datastream<char*> ds(result.data(), result.size());
+        ds << value;
+        return result;
+    }
+
+    template <typename T>
+    T unpack(const char* buffer, size_t len) {
+        T result {};
+        datastream<const char*> ds(buffer, len);
+        ds >> result;
+        return result;
+    }
+
+    template <typename T>
+    T unpack(const std::vector<char>& bytes) {
+        return unpack<T>(bytes.data(), bytes.size());
+    }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <eosio/action.hpp>
+#include <eosio/datastream.hpp>
+#include <eosio/name.hpp>
+
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace eosio {
+
+    // like CDT, only void members and no return value, that is set by the dispatcher CDT generates
+    template <typename T, typename... Args>
+    bool execute_action(name self, name code, void (T::*func)(Args...)) {
+        std::vector<char> buffer(action_data_size());
+        read_action_data(buffer.data(), buffer.size());
+
+        std::tuple<std::decay_t<Args>...> args;
+        datastream<const char*> ds(buffer.data(), buffer.size());
+        ds >> args;
+
+        T inst(self, code, ds);
+        auto f2 = [&](auto&... a) { ((&inst)->*func)(a...); };
+        std::apply(f2, args);
+        return true;
+    }
+
+}
+
+#define EOSIO_DISPATCH_INTERNAL(r, OP, elem) \
+    case eosio::name(BOOST_PP_STRINGIZE(elem)).value: \
+        eosio::execute_action(eosio::name(receiver), eosio::name(code), &OP::elem); \
+        break;
+
+#define EOSIO_DISPATCH_HELPER(TYPE, MEMBERS) \
+    BOOST_PP_SEQ_FOR_EACH(EOSIO_DISPATCH_INTERNAL, TYPE, MEMBERS)
+
+#define EOSIO_DISPATCH(TYPE, MEMBERS) \
+    extern "C" { \
+        void apply(uint64_t receiver, uint64_t code, uint64_t action) { \
+            if (code == receiver) { \
+                switch (action) { \
+                    EOSIO_DISPATCH_HELPER(TYPE, MEMBERS) \
+                } \
+            } \
+        } \
+    }
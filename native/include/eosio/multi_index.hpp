@@ -0,0 +1,428 @@
+#pragma once
+
+#include <eosio/datastream.hpp>
+#include <eosio/name.hpp>
+#include <eosio/native/intrinsics.hpp>
+
+#include <iterator>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace eosio {
+
+    constexpr static inline name same_payer {};
+
+    template <class Class, typename Type, Type (Class::*PtrToMemberFunction)() const>
+    struct const_mem_fun {
+        typedef typename std::remove_reference<Type>::type result_type;
+
+        template <typename ChainedPtr>
+        auto operator()(const ChainedPtr& x) const -> std::enable_if_t<!std::is_convertible_v<const ChainedPtr&, const Class&>, Type> {
+            return operator()(*x);
+        }
+
+        Type operator()(const Class& x) const { return (x.*PtrToMemberFunction)(); }
+    };
+
+    template <name::raw IndexName, typename Extractor>
+    struct indexed_by {
+        enum constants { index_name = static_cast<uint64_t>(IndexName) };
+        typedef Extractor secondary_extractor_type;
+    };
+
+    namespace detail {
+        template <typename Key>
+        constexpr uint8_t secondary_width() {
+            static_assert(std::is_same_v<Key, uint64_t> || std::is_same_v<Key, uint128_t>,
+                          "native multi_index supports uint64_t and uint128_t secondary keys");
+            return sizeof(Key);
+        }
+    }
+
+    template <name::raw TableName, typename T, typename... Indices>
+    class multi_index {
+        private:
+            static_assert(sizeof...(Indices) <= 16, "multi_index only supports a maximum of 16 secondary indices");
+
+            static constexpr uint64_t table_name = static_cast<uint64_t>(TableName);
+
+            static std::vector<native::db::secondary_entry> secondary_keys(const T& obj) {
+                std::vector<native::db::secondary_entry> keys;
+                keys.reserve(sizeof...(Indices));
+                (keys.push_back(native::db::secondary_entry {
+                    detail::secondary_width<typename Indices::secondary_extractor_type::result_type>(),
+                    native::db::secondary_key(typename Indices::secondary_extractor_type()(obj))
+                }), ...);
+                return keys;
+            }
+
+            const T& load(uint64_t pk) const {
+                auto cached = _items.find(pk);
+                if (cached != _items.end()) {
+                    return *cached->second;
+                }
+                auto bytes = native::db::find(_code.value, _scope, table_name, pk);
+                check(bytes != nullptr, "unable to find key");
+                auto item = std::make_unique<T>(unpack<T>(*bytes));
+                auto& ref = *item;
+                _items.emplace(pk, std::move(item));
+                return ref;
+            }
+
+            void require_writable() const {
+                check(_code.value == internal_use_do_not_use::current_receiver(), "cannot modify objects in table of another contract");
+            }
+
+        public:
+            struct const_iterator {
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type = const T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const T*;
+                using reference = const T&;
+
+                const T& operator*() const {
+                    check(!_end, "cannot dereference end iterator");
+                    return _multidx->load(_pk);
+                }
+                const T* operator->() const { return &operator*(); }
+
+                const_iterator& operator++() {
+                    check(!_end, "cannot increment end iterator");
+                    auto next = native::db::upper_bound(_multidx->_code.value, _multidx->_scope, table_name, _pk);
+                    if (next) {
+                        _pk = *next;
+                    } else {
+                        _end = true;
+                    }
+                    return *this;
+                }
+
+                const_iterator& operator--() {
+                    auto prev = _end ? native::db::last(_multidx->_code.value, _multidx->_scope, table_name)
+                                     : native::db::previous(_multidx->_code.value, _multidx->_scope, table_name, _pk);
+                    check(prev.has_value(), "cannot decrement iterator at beginning of table");
+                    _pk = *prev;
+                    _end = false;
+                    return *this;
+                }
+
+                const_iterator operator++(int) {
+                    const_iterator result(*this);
+                    ++(*this);
+                    return result;
+                }
+
+                const_iterator operator--(int) {
+                    const_iterator result(*this);
+                    --(*this);
+                    return result;
+                }
+
+                friend bool operator==(const const_iterator& a, const const_iterator& b) {
+                    return a._multidx == b._multidx && a._end == b._end && (a._end || a._pk == b._pk);
+                }
+                friend bool operator!=(const const_iterator& a, const const_iterator& b) { return !(a == b); }
+
+                const_iterator() = default;
+
+            private:
+                friend class multi_index;
+                const_iterator(const multi_index* idx) : _multidx(idx) {}
+                const_iterator(const multi_index* idx, uint64_t pk) : _multidx(idx), _pk(pk), _end(false) {}
+
+                const multi_index* _multidx = nullptr;
+                uint64_t _pk = 0;
+                bool _end = true;
+            };
+
+            typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+            multi_index(name code, uint64_t scope) : _code(code), _scope(scope) {}
+
+            multi_index(const multi_index&) = delete;
+            multi_index& operator=(const multi_index&) = delete;
+
+            name get_code() const { return _code; }
+            uint64_t get_scope() const { return _scope; }
+
+            const_iterator cbegin() const {
+                auto first = native::db::lower_bound(_code.value, _scope, table_name, 0);
+                return first ? const_iterator(this, *first) : end();
+            }
+            const_iterator begin() const { return cbegin(); }
+            const_iterator cend() const { return const_iterator(this); }
+            const_iterator end() const { return cend(); }
+            const_reverse_iterator rbegin() const { return std::make_reverse_iterator(cend()); }
+            const_reverse_iterator rend() const { return std::make_reverse_iterator(cbegin()); }
+
+            const_iterator lower_bound(uint64_t primary) const {
+                auto pk = native::db::lower_bound(_code.value, _scope, table_name, primary);
+                return pk ? const_iterator(this, *pk) : end();
+            }
+
+            const_iterator upper_bound(uint64_t primary) const {
+                auto pk = native::db::upper_bound(_code.value, _scope, table_name, primary);
+                return pk ? const_iterator(this, *pk) : end();
+            }
+
+            uint64_t available_primary_key() const {
+                if (!_next_primary_key_set) {
+                    auto last = native::db::last(_code.value, _scope, table_name);
+                    _next_primary_key = last ? *last + 1 : 0;
+                    _next_primary_key_set = true;
+                }
+                check(_next_primary_key < no_available_primary_key, "next primary key in table is at autoincrement limit");
+                return _next_primary_key;
+            }
+
+            template <name::raw IndexName>
+            auto get_index() const {
+                return get_index_impl<static_cast<uint64_t>(IndexName), 0, Indices...>();
+            }
+
+            const_iterator iterator_to(const T& obj) const {
+                auto pk = obj.primary_key();
+                auto cached = _items.find(pk);
+                check(cached != _items.end() && cached->second.get() == &obj, "object passed to iterator_to is not in multi_index");
+                return const_iterator(this, pk);
+            }
+
+            template <typename Lambda>
+            const_iterator emplace(name payer, Lambda&& constructor) {
+                require_writable();
+                check(payer.value != 0, "must specify a valid account to pay for new record");
+
+                auto item = std::make_unique<T>();
+                constructor(*item);
+                auto pk = item->primary_key();
+                check(native::db::find(_code.value, _scope, table_name, pk) == nullptr, "could not insert object, most likely a uniqueness constraint was violated");
+
+                native::db::store(_scope, table_name, payer.value, pk, pack(*item), secondary_keys(*item));
+                _items[pk] = std::move(item);
+
+                if (!_next_primary_key_set || pk >= _next_primary_key) {
+                    _next_primary_key = (pk >= no_available_primary_key) ? no_available_primary_key : pk + 1;
+                    _next_primary_key_set = true;
+                }
+                return const_iterator(this, pk);
+            }
+
+            template <typename Lambda>
+            void modify(const_iterator itr, name payer, Lambda&& updater) {
+                check(itr != end(), "cannot pass end iterator to modify");
+                modify(*itr, payer, std::forward<Lambda>(updater));
+            }
+
+            template <typename Lambda>
+            void modify(const T& obj, name payer, Lambda&& updater) {
+                require_writable();
+                auto pk = obj.primary_key();
+                auto cached = _items.find(pk);
+                check(cached != _items.end() && cached->second.get() == &obj, "object passed to modify is not in multi_index");
+
+                auto& mutableobj = const_cast<T&>(obj);
+                updater(mutableobj);
+                check(pk == mutableobj.primary_key(), "updater cannot change primary key when modifying an object");
+
+                native::db::update(_scope, table_name, payer.value, pk, pack(mutableobj), secondary_keys(mutableobj));
+            }
+
+            const T& get(uint64_t primary, const char* error_msg = "unable to find key") const {
+                auto result = find(primary);
+                check(result != cend(), error_msg);
+                return *result;
+            }
+
+            const_iterator find(uint64_t primary) const {
+                if (_items.count(primary) || native::db::find(_code.value, _scope, table_name, primary) != nullptr) {
+                    return const_iterator(this, primary);
+                }
+                return end();
+            }
+
+            const_iterator require_find(uint64_t primary, const char* error_msg = "unable to find key") const {
+                auto itr = find(primary);
+                check(itr != cend(), error_msg);
+                return itr;
+            }
+
+            const_iterator erase(const_iterator itr) {
+                check(itr != end(), "cannot pass end iterator to erase");
+                const auto& obj = *itr;
+                ++itr;
+                erase(obj);
+                return itr;
+            }
+
+            void erase(const T& obj) {
+                require_writable();
+                auto pk = obj.primary_key();
+                native::db::remove(_scope, table_name, pk);
+                _items.erase(pk);
+            }
+
+        private:
+            static constexpr uint64_t no_available_primary_key = static_cast<uint64_t>(-2);
+
+            template <uint64_t IndexName, uint32_t Number, typename Index, typename... Rest>
+            auto get_index_impl() const {
+                if constexpr (static_cast<uint64_t>(Index::index_name) == IndexName) {
+                    return secondary_index<multi_index, Number, IndexName, typename Index::secondary_extractor_type>(this);
+                } else {
+                    static_assert(sizeof...(Rest) > 0, "name provided is not the name of any secondary index within multi_index");
+                    return get_index_impl<IndexName, Number + 1, Rest...>();
+                }
+            }
+
+            name _code;
+            uint64_t _scope;
+            mutable std::map<uint64_t, std::unique_ptr<T>> _items;
+            mutable uint64_t _next_primary_key = 0;
+            mutable bool _next_primary_key_set = false;
+
+        public:
+            template <typename MultiIndex, uint32_t Number, uint64_t IndexName, typename Extractor>
+            class secondary_index {
+                public:
+                    typedef typename Extractor::result_type secondary_key_type;
+
+                    struct const_iterator {
+                        using iterator_category = std::bidirectional_iterator_tag;
+                        using value_type = const T;
+                        using difference_type = std::ptrdiff_t;
+                        using pointer = const T*;
+                        using reference = const T&;
+
+                        const T& operator*() const {
+                            check(!_end, "cannot dereference end iterator");
+                            return _multidx->load(_pos.second);
+                        }
+                        const T* operator->() const { return &operator*(); }
+
+                        const_iterator& operator++() {
+                            check(!_end, "cannot increment end iterator");
+                            auto next = native::db::idx_next(_multidx->_code.value, _multidx->_scope, table_name, Number, _pos);
+                            if (next) {
+                                _pos = *next;
+                            } else {
+                                _end = true;
+                            }
+                            return *this;
+                        }
+
+                        const_iterator& operator--() {
+                            auto prev = _end ? native::db::idx_last(_multidx->_code.value, _multidx->_scope, table_name, Number)
+                                             : native::db::idx_previous(_multidx->_code.value, _multidx->_scope, table_name, Number, _pos);
+                            check(prev.has_value(), "cannot decrement iterator at beginning of index");
+                            _pos = *prev;
+                            _end = false;
+                            return *this;
+                        }
+
+                        const_iterator operator++(int) {
+                            const_iterator result(*this);
+                            ++(*this);
+                            return result;
+                        }
+
+                        const_iterator operator--(int) {
+                            const_iterator result(*this);
+                            --(*this);
+                            return result;
+                        }
+
+                        friend bool operator==(const const_iterator& a, const const_iterator& b) {
+                            return a._multidx == b._multidx && a._end == b._end && (a._end || a._pos == b._pos);
+                        }
+                        friend bool operator!=(const const_iterator& a, const const_iterator& b) { return !(a == b); }
+
+                        const_iterator() = default;
+
+                    private:
+                        friend class secondary_index;
+                        const_iterator(const MultiIndex* midx) : _multidx(midx) {}
+                        const_iterator(const MultiIndex* midx, native::db::secondary_position pos) : _multidx(midx), _pos(pos), _end(false) {}
+
+                        const MultiIndex* _multidx = nullptr;
+                        native::db::secondary_position _pos {};
+                        bool _end = true;
+                    };
+
+                    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+                    secondary_index(const MultiIndex* midx) : _multidx(midx) {}
+
+                    static constexpr uint64_t name() { return IndexName; }
+                    static constexpr uint32_t number() { return Number; }
+
+                    const_iterator cbegin() const { return lower_bound(secondary_key_type {}); }
+                    const_iterator begin() const { return cbegin(); }
+                    const_iterator cend() const { return const_iterator(_multidx); }
+                    const_iterator end() const { return cend(); }
+                    const_reverse_iterator rbegin() const { return std::make_reverse_iterator(cend()); }
+                    const_reverse_iterator rend() const { return std::make_reverse_iterator(cbegin()); }
+
+                    const_iterator lower_bound(secondary_key_type key) const {
+                        auto pos = native::db::idx_lower_bound(code(), scope(), table_name, Number, native::db::secondary_key(key));
+                        return pos ? const_iterator(_multidx, *pos) : end();
+                    }
+
+                    const_iterator upper_bound(secondary_key_type key) const {
+                        auto pos = native::db::idx_upper_bound(code(), scope(), table_name, Number, native::db::secondary_key(key));
+                        return pos ? const_iterator(_multidx, *pos) : end();
+                    }
+
+                    const_iterator find(secondary_key_type key) const {
+                        auto itr = lower_bound(key);
+                        if (itr == end() || itr._pos.first != native::db::secondary_key(key)) {
+                            return end();
+                        }
+                        return itr;
+                    }
+
+                    const_iterator require_find(secondary_key_type key, const char* error_msg = "unable to find secondary key") const {
+                        auto itr = find(key);
+                        check(itr != end(), error_msg);
+                        return itr;
+                    }
+
+                    const T& get(secondary_key_type key, const char* error_msg = "unable to find secondary key") const {
+                        return *require_find(key, error_msg);
+                    }
+
+                    const_iterator iterator_to(const T& obj) const {
+                        _multidx->iterator_to(obj);
+                        return const_iterator(_multidx, { native::db::secondary_key(Extractor()(obj)), obj.primary_key() });
+                    }
+
+                    template <typename Lambda>
+                    void modify(const_iterator itr, eosio::name payer, Lambda&& updater) {
+                        check(itr != end(), "cannot pass end iterator to modify");
+                        const_cast<MultiIndex*>(_multidx)->modify(*itr, payer, std::forward<Lambda>(updater));
+                    }
+
+                    const_iterator erase(const_iterator itr) {
+                        check(itr != end(), "cannot pass end iterator to erase");
+                        const auto& obj = *itr;
+                        ++itr;
+                        const_cast<MultiIndex*>(_multidx)->erase(obj);
+                        return itr;
+                    }
+
+                    static auto extract_secondary_key(const T& obj) { return secondary_key_type(Extractor()(obj)); }
+
+                private:
+                    friend class multi_index;
+
+                    uint64_t code() const { return _multidx->_code.value; }
+                    uint64_t scope() const { return _multidx->_scope; }
+
+                    const MultiIndex* _multidx;
+            };
+    };
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <eosio/check.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace eosio {
+
+    /**
+     * Native stand-in for `eosio::name`: a 64 bit value holding up to 13 base32 characters.
+     * All members are public so the type can be used as a non-type template parameter.
+     */
+    struct name {
+        enum class raw : uint64_t {};
+
+        uint64_t value = 0;
+
+        constexpr name() = default;
+        constexpr explicit name(uint64_t v) : value(v) {}
+        constexpr explicit name(name::raw r) : value(static_cast<uint64_t>(r)) {}
+        constexpr explicit name(std::string_view str) {
+            if (str.size() > 13) {
+                check(false, "string is too long to be a valid name");
+            }
+            if (str.empty()) {
+                return;
+            }
+            auto n = std::min(str.size(), size_t(12));
+            for (size_t i = 0; i < n; ++i) {
+                value <<= 5;
+                value |= char_to_value(str[i]);
+            }
+            value <<= (4 + 5 * (12 - n));
+            if (str.size() == 13) {
+                uint64_t v = char_to_value(str[12]);
+                if (v > 0x0Full) {
+                    check(false, "thirteenth character in name cannot be a letter that comes after j");
+                }
+                value |= v;
+            }
+        }
+
+        static constexpr uint8_t char_to_value(char c) {
+            if (c == '.') {
+                return 0;
+            } else if (c >= '1' && c <= '5') {
+                return (c - '1') + 1;
+            } else if (c >= 'a' && c <= 'z') {
+                return (c - 'a') + 6;
+            }
+            check(false, "character is not in allowed character set for names");
+            return 0;
+        }
+
+        constexpr uint8_t length() const {
+            constexpr uint64_t mask = 0xF800000000000000ull;
+            if (value == 0) {
+                return 0;
+            }
+            uint8_t l = 0;
+            uint8_t i = 0;
+            for (auto v = value; i < 13; ++i, v <<= 5) {
+                if ((v & mask) > 0) {
+                    l = i;
+                }
+            }
+            return l + 1;
+        }
+
+        constexpr operator raw() const { return raw(value); }
+        constexpr explicit operator bool() const { return value != 0; }
+
+        std::string to_string() const {
+            static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+            std::string str(13, '.');
+            uint64_t tmp = value;
+            for (uint32_t i = 0; i <= 12; ++i) {
+                char c = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
+                str[12 - i] = c;
+                tmp >>= (i == 0 ? 4 : 5);
+            }
+            auto end = str.find_last_not_of('.');
+            str.resize(end == std::string::npos ? 0 : end + 1);
+            return str;
+        }
+
+        void print() const { native::print_console(to_string()); }
+
+        friend constexpr bool operator==(const name& a, const name& b) { return a.value == b.value; }
+        friend constexpr bool operator!=(const name& a, const name& b) { return a.value != b.value; }
+        friend constexpr bool operator<(const name& a, const name& b) { return a.value < b.value; }
+        friend constexpr bool operator>(const name& a, const name& b) { return a.value > b.value; }
+        friend constexpr bool operator<=(const name& a, const name& b) { return a.value <= b.value; }
+        friend constexpr bool operator>=(const name& a, const name& b) { return a.value >= b.value; }
+    };
+
+    namespace detail {
+        template <size_t N>
+        struct fixed_string {
+            char data[N] {};
+            constexpr fixed_string(const char (&str)[N]) {
+                for (size_t i = 0; i < N; ++i) {
+                    data[i] = str[i];
+                }
+            }
+            constexpr std::string_view view() const { return std::string_view(data, N - 1); }
+        };
+    }
+
+    inline namespace literals {
+        template <detail::fixed_string Str>
+        constexpr name operator""_n() {
+            constexpr auto n = name(Str.view());
+            return n;
+        }
+    }
+
+}
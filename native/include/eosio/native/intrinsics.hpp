@@ -0,0 +1,63 @@
+#pragma once
+
+#include <eosio/check.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace eosio {
+
+    /**
+     * Host functions the CDT imports from nodeos. The native build links them
+     * against the in-memory chain in `native/src/chain.cpp`.
+     */
+    namespace internal_use_do_not_use {
+        uint32_t read_action_data(void* msg, uint32_t len);
+        uint32_t action_data_size();
+        void require_recipient(uint64_t name);
+        void require_auth(uint64_t name);
+        void require_auth2(uint64_t name, uint64_t permission);
+        bool has_auth(uint64_t name);
+        bool is_account(uint64_t name);
+        void send_inline(char* serialized_action, size_t size);
+        uint64_t current_time();
+        uint64_t current_receiver();
+        void set_action_return_value(void* return_value, size_t size);
+    }
+
+    /**
+     * Table storage used by the native `multi_index`. Rows are kept serialized so that
+     * contracts reading each other's tables through their own struct layouts see the
+     * same bytes they would on chain, and so RAM billing matches the row sizes.
+     */
+    namespace native::db {
+        using secondary_key = uint128_t;
+
+        struct secondary_entry {
+            uint8_t width;
+            secondary_key key;
+        };
+
+        const std::vector<char>* find(uint64_t code, uint64_t scope, uint64_t table, uint64_t pk);
+        std::optional<uint64_t> lower_bound(uint64_t code, uint64_t scope, uint64_t table, uint64_t pk);
+        std::optional<uint64_t> upper_bound(uint64_t code, uint64_t scope, uint64_t table, uint64_t pk);
+        std::optional<uint64_t> previous(uint64_t code, uint64_t scope, uint64_t table, uint64_t pk);
+        std::optional<uint64_t> last(uint64_t code, uint64_t scope, uint64_t table);
+
+        void store(uint64_t scope, uint64_t table, uint64_t payer, uint64_t pk, std::vector<char> data, std::vector<secondary_entry> keys);
+        void update(uint64_t scope, uint64_t table, uint64_t payer, uint64_t pk, std::vector<char> data, std::vector<secondary_entry> keys);
+        void remove(uint64_t scope, uint64_t table, uint64_t pk);
+
+        using secondary_position = std::pair<secondary_key, uint64_t>;
+
+        std::optional<secondary_position> idx_lower_bound(uint64_t code, uint64_t scope, uint64_t table, uint32_t index, secondary_key key);
+        std::optional<secondary_position> idx_upper_bound(uint64_t code, uint64_t scope, uint64_t table, uint32_t index, secondary_key key);
+        std::optional<secondary_position> idx_next(uint64_t code, uint64_t scope, uint64_t table, uint32_t index, secondary_position pos);
+        std::optional<secondary_position> idx_previous(uint64_t code, uint64_t scope, uint64_t table, uint32_t index, secondary_position pos);
+        std::optional<secondary_position> idx_last(uint64_t code, uint64_t scope, uint64_t table, uint32_t index);
+    }
+
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <eosio/check.hpp>
+#include <eosio/native/intrinsics.hpp>
+#include <eosio/time.hpp>
+
+namespace eosio {
+
+    inline time_point current_time_point() {
+        return time_point(microseconds(int64_t(internal_use_do_not_use::current_time())));
+    }
+
+    inline block_timestamp current_block_time() {
+        return block_timestamp(current_time_point());
+    }
+
+}
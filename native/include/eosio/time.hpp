@@ -0,0 +1,125 @@
+#pragma once
+
+#include <eosio/check.hpp>
+
+#include <cstdint>
+
+namespace eosio {
+
+    class microseconds {
+        public:
+            constexpr microseconds() : _count(0) {}
+            constexpr explicit microseconds(int64_t c) : _count(c) {}
+            constexpr int64_t count() const { return _count; }
+            constexpr int64_t to_seconds() const { return _count / 1000000; }
+
+            constexpr microseconds& operator+=(const microseconds& c) { _count += c._count; return *this; }
+            constexpr microseconds& operator-=(const microseconds& c) { _count -= c._count; return *this; }
+            friend constexpr microseconds operator+(const microseconds& l, const microseconds& r) { return microseconds(l._count + r._count); }
+            friend constexpr microseconds operator-(const microseconds& l, const microseconds& r) { return microseconds(l._count - r._count); }
+            friend constexpr bool operator==(const microseconds& a, const microseconds& b) { return a._count == b._count; }
+            friend constexpr bool operator!=(const microseconds& a, const microseconds& b) { return a._count != b._count; }
+            friend constexpr bool operator<(const microseconds& a, const microseconds& b) { return a._count < b._count; }
+            friend constexpr bool operator<=(const microseconds& a, const microseconds& b) { return a._count <= b._count; }
+            friend constexpr bool operator>(const microseconds& a, const microseconds& b) { return a._count > b._count; }
+            friend constexpr bool operator>=(const microseconds& a, const microseconds& b) { return a._count >= b._count; }
+
+            int64_t _count;
+    };
+
+    inline constexpr microseconds seconds(int64_t s) { return microseconds(s * 1000000); }
+    inline constexpr microseconds milliseconds(int64_t s) { return microseconds(s * 1000); }
+    inline constexpr microseconds minutes(int64_t m) { return seconds(60 * m); }
+    inline constexpr microseconds hours(int64_t h) { return minutes(60 * h); }
+    inline constexpr microseconds days(int64_t d) { return hours(24 * d); }
+
+    class time_point {
+        public:
+            constexpr time_point() {}
+            constexpr explicit time_point(microseconds e) : elapsed(e) {}
+            constexpr const microseconds& time_since_epoch() const { return elapsed; }
+            constexpr uint32_t sec_since_epoch() const { return uint32_t(elapsed.count() / 1000000); }
+
+            constexpr time_point& operator+=(const microseconds& m) { elapsed += m; return *this; }
+            constexpr time_point& operator-=(const microseconds& m) { elapsed -= m; return *this; }
+            friend constexpr time_point operator+(const time_point& t, const microseconds& m) { return time_point(t.elapsed + m); }
+            friend constexpr time_point operator-(const time_point& t, const microseconds& m) { return time_point(t.elapsed - m); }
+            friend constexpr microseconds operator-(const time_point& a, const time_point& b) { return a.elapsed - b.elapsed; }
+            friend constexpr bool operator==(const time_point& a, const time_point& b) { return a.elapsed == b.elapsed; }
+            friend constexpr bool operator!=(const time_point& a, const time_point& b) { return a.elapsed != b.elapsed; }
+            friend constexpr bool operator<(const time_point& a, const time_point& b) { return a.elapsed < b.elapsed; }
+            friend constexpr bool operator<=(const time_point& a, const time_point& b) { return a.elapsed <= b.elapsed; }
+            friend constexpr bool operator>(const time_point& a, const time_point& b) { return a.elapsed > b.elapsed; }
+            friend constexpr bool operator>=(const time_point& a, const time_point& b) { return a.elapsed >= b.elapsed; }
+
+            microseconds elapsed;
+    };
+
+    class time_point_sec {
+        public:
+            constexpr time_point_sec() : utc_seconds(0) {}
+            constexpr explicit time_point_sec(uint32_t seconds) : utc_seconds(seconds) {}
+            constexpr time_point_sec(const time_point& t) : utc_seconds(uint32_t(t.time_since_epoch().count() / 1000000ll)) {}
+
+            constexpr operator time_point() const { return time_point(eosio::seconds(utc_seconds)); }
+            constexpr uint32_t sec_since_epoch() const { return utc_seconds; }
+
+            constexpr time_point_sec& operator+=(uint32_t m) { utc_seconds += m; return *this; }
+            friend constexpr time_point_sec operator+(const time_point_sec& t, uint32_t offset) { return time_point_sec(t.utc_seconds + offset); }
+            friend constexpr bool operator==(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds == b.utc_seconds; }
+            friend constexpr bool operator!=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds != b.utc_seconds; }
+            friend constexpr bool operator<(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds < b.utc_seconds; }
+            friend constexpr bool operator<=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds <= b.utc_seconds; }
+            friend constexpr bool operator>(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds > b.utc_seconds; }
+            friend constexpr bool operator>=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds >= b.utc_seconds; }
+
+            uint32_t utc_seconds;
+    };
+
+    /**
+     * Half-second block slots counted from 2000-01-01, matching the chain's `block_timestamp_type`.
+     */
+    class block_timestamp {
+        public:
+            static constexpr int32_t block_interval_ms = 500;
+            static constexpr int64_t block_timestamp_epoch = 946684800000ll;
+
+            constexpr block_timestamp() {}
+            constexpr explicit block_timestamp(uint32_t s) : slot(s) {}
+            constexpr block_timestamp(const time_point& t) { set_time_point(t); }
+            constexpr block_timestamp(const time_point_sec& t) { set_time_point(t); }
+
+            constexpr time_point to_time_point() const {
+                int64_t msec = slot * (int64_t)block_interval_ms;
+                msec += block_timestamp_epoch;
+                return time_point(milliseconds(msec));
+            }
+            constexpr operator time_point() const { return to_time_point(); }
+
+            constexpr block_timestamp next() const { return block_timestamp(slot + 1); }
+
+            friend constexpr bool operator==(const block_timestamp& a, const block_timestamp& b) { return a.slot == b.slot; }
+            friend constexpr bool operator!=(const block_timestamp& a, const block_timestamp& b) { return a.slot != b.slot; }
+            friend constexpr bool operator<(const block_timestamp& a, const block_timestamp& b) { return a.slot < b.slot; }
+            friend constexpr bool operator<=(const block_timestamp& a, const block_timestamp& b) { return a.slot <= b.slot; }
+            friend constexpr bool operator>(const block_timestamp& a, const block_timestamp& b) { return a.slot > b.slot; }
+            friend constexpr bool operator>=(const block_timestamp& a, const block_timestamp& b) { return a.slot >= b.slot; }
+
+            uint32_t slot = 0;
+
+        private:
+            constexpr void set_time_point(const time_point& t) {
+                int64_t micro_since_epoch = t.time_since_epoch().count();
+                int64_t msec_since_epoch = micro_since_epoch / 1000;
+                slot = uint32_t((msec_since_epoch - block_timestamp_epoch) / int64_t(block_interval_ms));
+            }
+
+            constexpr void set_time_point(const time_point_sec& t) {
+                int64_t sec_since_epoch = t.sec_since_epoch();
+                slot = uint32_t((sec_since_epoch * 1000 - block_timestamp_epoch) / block_interval_ms);
+            }
+    };
+
+    typedef block_timestamp block_timestamp_type;
+
+}
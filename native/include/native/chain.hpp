@@ -0,0 +1,188 @@
+#pragma once
+
+#include <eosio/action.hpp>
+#include <eosio/datastream.hpp>
+#include <eosio/name.hpp>
+#include <eosio/native/intrinsics.hpp>
+#include <eosio/time.hpp>
+
+#include <array>
+#include <chrono>
+#include <compare>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace eosio::native {
+
+    using apply_handler = void (*)(uint64_t receiver, uint64_t code, uint64_t action);
+
+    /**
+     * RAM billed per object, mirroring `billable_size` in nodeos' chain config.
+     */
+    struct billable_size {
+        static constexpr int64_t overhead_per_row_per_index = 32;
+        static constexpr int64_t table_id = 44 + overhead_per_row_per_index * 2;
+        static constexpr int64_t key_value = 32 + 8 + 4 + overhead_per_row_per_index * 2;
+        static constexpr int64_t index64 = 24 + 8 + overhead_per_row_per_index * 3;
+        static constexpr int64_t index128 = 24 + 16 + overhead_per_row_per_index * 3;
+    };
+
+    struct table_id {
+        uint64_t code;
+        uint64_t scope;
+        uint64_t table;
+        auto operator<=>(const table_id&) const = default;
+    };
+
+    struct db_row {
+        name payer;
+        std::vector<char> data;
+        std::vector<db::secondary_entry> keys;
+        int64_t billed = 0;
+    };
+
+    struct db_table {
+        name payer;
+        std::map<uint64_t, db_row> rows;
+        std::array<std::set<db::secondary_position>, 16> indexes;
+    };
+
+    struct counters {
+        uint64_t actions = 0;
+        uint64_t inline_actions = 0;
+        uint64_t notifications = 0;
+        uint64_t db_reads = 0;
+        uint64_t db_writes = 0;
+    };
+
+    struct action_trace {
+        name receiver;
+        name account;
+        name action;
+        uint32_t depth;
+    };
+
+    struct transaction_result {
+        bool succeeded = false;
+        std::string error;
+        std::vector<action_trace> traces;
+        std::vector<char> return_value;
+        counters stats;
+        std::map<name, int64_t> ram_delta;
+        std::chrono::nanoseconds elapsed {0};
+
+        template <typename T>
+        T return_as() const { return unpack<T>(return_value); }
+    };
+
+    /**
+     * In-memory stand-in for a single nodeos instance: accounts, contract code,
+     * tables, authorization, inline actions and notifications. Transactions are
+     * atomic; a failed `check` rolls back every table and RAM change it made.
+     * Like nodeos with RAM_RESTRICTIONS, an action may only bill RAM to its
+     * receiver or to an account that authorized it, and a notification only
+     * to its receiver.
+     *
+     * Only one chain can be active at a time, since contract code reaches it
+     * through the global host functions.
+     */
+    class chain {
+        public:
+            chain();
+            ~chain();
+
+            chain(const chain&) = delete;
+            chain& operator=(const chain&) = delete;
+
+            static chain& active();
+
+            void create_account(name account);
+            bool is_account(name account) const;
+            void set_code(name account, apply_handler handler);
+            // let `code` send inline actions with `account@active`, like adding `code@eosio.code`
+            void grant_code(name account, name code);
+
+            time_point now() const { return _now; }
+            void set_time(time_point t) { _now = t; }
+            void advance(microseconds m) { _now += m; }
+
+            transaction_result push_action(name account, name act, std::vector<permission_level> auth, std::vector<char> data, bool read_only = false);
+
+            template <typename... Args>
+            transaction_result push(name account, name act, name actor, const Args&... args) {
+                return push_action(account, act, { permission_level(actor, name("active")) }, pack(std::make_tuple(args...)));
+            }
+
+            template <typename... Args>
+            transaction_result read(name account, name act, const Args&... args) {
+                return push_action(account, act, {}, pack(std::make_tuple(args...)), true);
+            }
+
+            int64_t ram_usage(name account) const;
+            const std::map<table_id, db_table>& tables() const { return _tables; }
+            const db_table* find_table(name code, uint64_t scope, name table) const;
+
+            template <typename T>
+            std::optional<T> get_row(name code, uint64_t scope, name table, uint64_t pk) const {
+                auto t = find_table(code, scope, table);
+                if (!t) {
+                    return std::nullopt;
+                }
+                auto itr = t->rows.find(pk);
+                if (itr == t->rows.end()) {
+                    return std::nullopt;
+                }
+                return unpack<T>(itr->second.data);
+            }
+
+            // host function implementations, called through the `eosio` intrinsics
+
+            struct pending_action {
+                name sender;
+                action act;
+            };
+
+            struct apply_context {
+                name receiver;
+                const action* act;
+                std::vector<name> notified;
+                std::vector<pending_action> inlines;
+                std::vector<char> return_value;
+                // RAM billed while the current receiver runs, checked against its authorization afterwards
+                std::map<name, int64_t> ram_delta;
+            };
+
+            apply_context& context();
+            counters& stats() { return _stats; }
+
+            db_table* writable_table(uint64_t scope, uint64_t table, bool create);
+            const db_table* readable_table(uint64_t code, uint64_t scope, uint64_t table);
+            void bill(name payer, int64_t bytes);
+            void drop_table_if_empty(uint64_t scope, uint64_t table);
+
+        private:
+            void execute(const action& act, uint32_t depth, std::vector<action_trace>& traces);
+
+            std::set<name> _accounts;
+            std::map<name, apply_handler> _code;
+            std::set<std::pair<name, name>> _code_grants;
+            time_point _now;
+
+            std::map<table_id, db_table> _tables;
+            std::map<name, int64_t> _ram;
+
+            // transaction state
+            std::vector<apply_context*> _contexts;
+            std::map<table_id, std::optional<db_table>> _undo;
+            std::map<name, int64_t> _ram_delta;
+            std::vector<char> _return_value;
+            counters _stats;
+            bool _in_transaction = false;
+            bool _read_only = false;
+    };
+
+}
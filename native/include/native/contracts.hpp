@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Entry points of the three contracts compiled for the host. Each contract's
+ * `apply` is renamed so they can be linked into one binary.
+ */
+extern "C" {
+    void ifttoken_apply(uint64_t receiver, uint64_t code, uint64_t action);
+    void stakedtoken_apply(uint64_t receiver, uint64_t code, uint64_t action);
+    void staking_apply(uint64_t receiver, uint64_t code, uint64_t action);
+}
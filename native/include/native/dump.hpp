@@ -0,0 +1,25 @@
+#pragma once
+
+#include <native/chain.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace eosio::native {
+
+    /**
+     * Table dumps read by `analytics`. A binary dump is the 8 byte magic `IFTDUMP1`
+     * followed by one record per row: code, scope, table and primary key as little
+     * endian uint64, the row size as uint32, then the row bytes. A JSON dump has one
+     * row per line, `{"code":"...","scope":"...","table":"...","primary_key":N,"data":"<hex>"}`.
+     *
+     * Row bytes are what the contract stored, the same bytes `get_table_rows` returns
+     * with `json: false`, so dumps taken from a node decode the same way.
+     */
+    constexpr char dump_magic[8] = { 'I', 'F', 'T', 'D', 'U', 'M', 'P', '1' };
+    constexpr size_t dump_record_header_size = 8 * 4 + 4;
+
+    // writes every row of `c`, as JSON lines when `path` ends in ".jsonl"
+    void write_dump(const chain& c, const std::string& path);
+
+}
@@ -0,0 +1,455 @@
+#include <native/dump.hpp>
+
+#include <stakedtoken.hpp>
+#include <staking.hpp>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace eosio;
+
+/**
+ * Aggregates over table dumps (see native/dump.hpp): holder distribution per token,
+ * SIFT locked per release date, locked/issued and APY per staked symbol. Each file
+ * is mapped and cut into one chunk per thread at row boundaries; every thread decodes
+ * its rows with the contracts' own table structs into private aggregates, merged once
+ * at the end. Files are reported in the order given, so a series of dumps is a history.
+ * Results go to stdout as one JSON document.
+ */
+
+struct options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t now = uint32_t(std::time(nullptr));
+    size_t top = 10;
+    std::vector<std::string> files;
+};
+
+struct row_ref {
+    uint64_t code;
+    uint64_t scope;
+    uint64_t table;
+    const char* data;
+    size_t size;
+};
+
+// a token is its contract and symbol code
+struct token_key {
+    uint64_t code;
+    uint64_t sym;
+    auto operator<=>(const token_key&) const = default;
+};
+
+struct holders {
+    symbol sym;
+    uint64_t count = 0;
+    uint64_t empty = 0;
+    int64_t total = 0;
+    // whole tokens held: below 1, then one bin per power of ten, the last is 10^10 and up
+    std::array<uint64_t, 12> histogram {};
+    // the largest balances as (amount, owner), a min heap of at most `top` entries
+    std::vector<std::pair<int64_t, uint64_t>> top;
+};
+
+struct aggregates {
+    uint64_t rows = 0;
+    uint64_t skipped = 0;
+    std::map<token_key, holders> tokens;
+    std::map<token_key, asset> supply;
+    // live locked amount per release day
+    std::map<token_key, std::map<uint32_t, uint64_t>> locked;
+    std::vector<std::pair<uint64_t, staking::st_symbol>> symbols;
+    std::optional<staking::epoch> epoch;
+};
+
+struct mapped_file {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    explicit mapped_file(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            std::fprintf(stderr, "cannot open %s\n", path.c_str());
+            std::exit(1);
+        }
+        size = st.st_size;
+        if (size > 0) {
+            void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                std::fprintf(stderr, "cannot map %s\n", path.c_str());
+                std::exit(1);
+            }
+            ::madvise(p, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(p);
+        }
+        ::close(fd);
+    }
+    ~mapped_file() {
+        if (data) {
+            ::munmap(const_cast<char*>(data), size);
+        }
+    }
+};
+
+static const name accounts_table("accounts"), stat_table("stat"), locks_table("locks"), lockpacks_table("lockpacks"),
+    symbols_table("symbols"), epoch_table("epoch");
+
+static void push_top(std::vector<std::pair<int64_t, uint64_t>>& top, size_t limit, std::pair<int64_t, uint64_t> entry) {
+    auto greater = std::greater<std::pair<int64_t, uint64_t>>();
+    if (top.size() < limit) {
+        top.push_back(entry);
+        std::push_heap(top.begin(), top.end(), greater);
+    } else if (limit > 0 && entry > top.front()) {
+        std::pop_heap(top.begin(), top.end(), greater);
+        top.back() = entry;
+        std::push_heap(top.begin(), top.end(), greater);
+    }
+}
+
+static uint32_t release_day(const block_timestamp& t) {
+    return t.to_time_point().sec_since_epoch() / 86400;
+}
+
+static void add_row(aggregates& agg, const options& opt, const row_ref& row) {
+    agg.rows++;
+    name table(row.table);
+    try {
+        if (table == accounts_table) {
+            auto a = unpack<token::account>(row.data, row.size);
+            auto& h = agg.tokens[{ row.code, a.balance.symbol.code().raw() }];
+            h.sym = a.balance.symbol;
+            if (a.balance.amount == 0) {
+                h.empty++;
+                return;
+            }
+            h.count++;
+            h.total += a.balance.amount;
+            int64_t whole = a.balance.amount;
+            for (int p = 0; p < a.balance.symbol.precision(); p++) {
+                whole /= 10;
+            }
+            size_t bin = 0;
+            for (; whole > 0 && bin + 1 < h.histogram.size(); whole /= 10) {
+                bin++;
+            }
+            h.histogram[bin]++;
+            push_top(h.top, opt.top, { a.balance.amount, row.scope });
+        } else if (table == stat_table) {
+            auto st = unpack<token::currency_stats>(row.data, row.size);
+            agg.supply[{ row.code, st.supply.symbol.code().raw() }] = st.supply;
+        } else if (table == locks_table) {
+            auto l = unpack<token::st_lock>(row.data, row.size);
+            if (l.release_time.to_time_point().sec_since_epoch() > opt.now) {
+                agg.locked[{ row.code, l.sym.raw() }][release_day(l.release_time)] += l.amount;
+            }
+        } else if (table == lockpacks_table) {
+            auto p = unpack<token::st_lockpack>(row.data, row.size);
+            auto& days = agg.locked[{ row.code, p.sym.raw() }];
+            for (const auto& b : p.buckets) {
+                if (b.release_time.to_time_point().sec_since_epoch() > opt.now) {
+                    days[release_day(b.release_time)] += b.amount;
+                }
+            }
+        } else if (table == symbols_table) {
+            agg.symbols.emplace_back(row.code, unpack<staking::st_symbol>(row.data, row.size));
+        } else if (table == epoch_table) {
+            agg.epoch = unpack<staking::epoch>(row.data, row.size);
+        }
+    } catch (const eosio_assert_failure&) {
+        // a table of another contract sharing the name
+        agg.skipped++;
+    }
+}
+
+static void merge(aggregates& into, aggregates&& from, const options& opt) {
+    into.rows += from.rows;
+    into.skipped += from.skipped;
+    for (auto& [key, h] : from.tokens) {
+        auto& to = into.tokens[key];
+        to.sym = h.sym;
+        to.count += h.count;
+        to.empty += h.empty;
+        to.total += h.total;
+        for (size_t i = 0; i < h.histogram.size(); i++) {
+            to.histogram[i] += h.histogram[i];
+        }
+        for (auto& entry : h.top) {
+            push_top(to.top, opt.top, entry);
+        }
+    }
+    into.supply.merge(from.supply);
+    for (auto& [key, days] : from.locked) {
+        auto& to = into.locked[key];
+        for (auto& [day, amount] : days) {
+            to[day] += amount;
+        }
+    }
+    into.symbols.insert(into.symbols.end(), from.symbols.begin(), from.symbols.end());
+    if (from.epoch) {
+        into.epoch = from.epoch;
+    }
+}
+
+static std::string_view json_field(std::string_view line, std::string_view key) {
+    // the flat objects write_dump emits, string values are quoted, numbers are not
+    std::string pattern = "\"" + std::string(key) + "\":";
+    auto pos = line.find(pattern);
+    if (pos == std::string_view::npos) {
+        return {};
+    }
+    pos += pattern.size();
+    if (pos < line.size() && line[pos] == '"') {
+        auto end = line.find('"', pos + 1);
+        return end == std::string_view::npos ? std::string_view() : line.substr(pos + 1, end - pos - 1);
+    }
+    auto end = line.find_first_of(",}", pos);
+    return line.substr(pos, end - pos);
+}
+
+static int hex_value(char c) {
+    return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+}
+
+static void scan_json(aggregates& agg, const options& opt, const char* begin, const char* end) {
+    std::vector<char> bytes;
+    while (begin < end) {
+        auto eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        std::string_view line(begin, (eol ? eol : end) - begin);
+        begin = eol ? eol + 1 : end;
+        auto hex = json_field(line, "data");
+        auto table = json_field(line, "table");
+        if (table.empty() || hex.size() % 2) {
+            if (!line.empty()) {
+                agg.skipped++;
+            }
+            continue;
+        }
+        bytes.resize(hex.size() / 2);
+        for (size_t i = 0; i < bytes.size(); i++) {
+            bytes[i] = char(hex_value(hex[2 * i]) << 4 | hex_value(hex[2 * i + 1]));
+        }
+        try {
+            add_row(agg, opt, { name(json_field(line, "code")).value, name(json_field(line, "scope")).value, name(table).value,
+                bytes.data(), bytes.size() });
+        } catch (const eosio_assert_failure&) {
+            agg.skipped++;
+        }
+    }
+}
+
+static void scan_binary(aggregates& agg, const options& opt, const char* begin, const char* end) {
+    while (begin + native::dump_record_header_size <= end) {
+        uint64_t keys[4];
+        uint32_t size;
+        std::memcpy(keys, begin, sizeof(keys));
+        std::memcpy(&size, begin + sizeof(keys), sizeof(size));
+        begin += native::dump_record_header_size;
+        add_row(agg, opt, { keys[0], keys[1], keys[2], begin, size });
+        begin += size;
+    }
+}
+
+// chunk boundaries, each at the start of a row
+static std::vector<const char*> split(const mapped_file& f, bool binary, unsigned parts) {
+    const char* begin = f.data + (binary ? sizeof(native::dump_magic) : 0);
+    const char* end = f.data + f.size;
+    std::vector<const char*> cuts { begin };
+    size_t step = (end - begin) / parts + 1;
+    if (binary) {
+        // the row sizes chain the records, so the cuts take one pass over the headers
+        const char* next = begin + step;
+        for (const char* p = begin; p + native::dump_record_header_size <= end;) {
+            if (p >= next) {
+                cuts.push_back(p);
+                next = p + step;
+            }
+            uint32_t size;
+            std::memcpy(&size, p + 32, sizeof(size));
+            p += native::dump_record_header_size + size;
+        }
+    } else {
+        for (const char* p = begin + step; p < end; p += step) {
+            auto eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!eol) {
+                break;
+            }
+            p = eol + 1;
+            cuts.push_back(p);
+        }
+    }
+    cuts.push_back(end);
+    return cuts;
+}
+
+static aggregates scan(const std::string& path, const options& opt) {
+    mapped_file f(path);
+    bool binary = f.size >= sizeof(native::dump_magic) && std::memcmp(f.data, native::dump_magic, sizeof(native::dump_magic)) == 0;
+    if (f.size == 0) {
+        return {};
+    }
+    auto cuts = split(f, binary, opt.threads);
+    std::vector<aggregates> parts(cuts.size() - 1);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i + 1 < cuts.size(); i++) {
+        workers.emplace_back([&, i] {
+            if (binary) {
+                scan_binary(parts[i], opt, cuts[i], cuts[i + 1]);
+            } else {
+                scan_json(parts[i], opt, cuts[i], cuts[i + 1]);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    aggregates total;
+    for (auto& part : parts) {
+        merge(total, std::move(part), opt);
+    }
+    return total;
+}
+
+static std::string amount_string(int64_t amount, const std::optional<symbol>& sym) {
+    return sym ? asset(amount, *sym).to_string() : std::to_string(amount);
+}
+
+static std::string date_string(uint32_t day) {
+    std::time_t t = std::time_t(day) * 86400;
+    std::tm tm;
+    gmtime_r(&t, &tm);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &tm);
+    return buffer;
+}
+
+static void print_snapshot(const std::string& path, const aggregates& agg, double seconds, bool last) {
+    auto symbol_of = [&](const token_key& key) -> std::optional<symbol> {
+        auto itr = agg.supply.find(key);
+        return itr == agg.supply.end() ? std::nullopt : std::optional<symbol>(itr->second.symbol);
+    };
+
+    std::printf("    {\"file\": \"%s\", \"rows\": %llu, \"skipped\": %llu, \"seconds\": %.3f,\n", path.c_str(),
+        (unsigned long long)agg.rows, (unsigned long long)agg.skipped, seconds);
+    if (agg.epoch) {
+        std::printf("     \"epoch\": {\"number\": %llu, \"length\": %llu, \"end_time\": %llu},\n", (unsigned long long)agg.epoch->number,
+            (unsigned long long)agg.epoch->length, (unsigned long long)agg.epoch->end_time);
+    } else {
+        std::printf("     \"epoch\": null,\n");
+    }
+
+    std::printf("     \"holders\": [");
+    const char* sep = "\n";
+    for (const auto& [key, h] : agg.tokens) {
+        auto sym = std::optional<symbol>(h.sym);
+        auto supply = agg.supply.find(key);
+        auto top = h.top;
+        std::sort_heap(top.begin(), top.end(), std::greater<std::pair<int64_t, uint64_t>>());
+        int64_t top_total = 0;
+        for (auto& [amount, owner] : top) {
+            top_total += amount;
+        }
+        std::printf("%s      {\"contract\": \"%s\", \"symbol\": \"%s\", \"supply\": \"%s\", \"holders\": %llu, \"empty\": %llu, \"total\": \"%s\", \"top_share\": %.6f,\n",
+            sep, name(key.code).to_string().c_str(), h.sym.code().to_string().c_str(),
+            supply == agg.supply.end() ? "" : supply->second.to_string().c_str(), (unsigned long long)h.count, (unsigned long long)h.empty,
+            amount_string(h.total, sym).c_str(), h.total > 0 ? double(top_total) / h.total : 0.0);
+        std::printf("       \"histogram\": [");
+        for (size_t i = 0; i < h.histogram.size(); i++) {
+            std::printf("%s%llu", i ? ", " : "", (unsigned long long)h.histogram[i]);
+        }
+        std::printf("],\n       \"top\": [");
+        for (size_t i = 0; i < top.size(); i++) {
+            std::printf("%s{\"owner\": \"%s\", \"balance\": \"%s\"}", i ? ", " : "", name(top[i].second).to_string().c_str(),
+                amount_string(top[i].first, sym).c_str());
+        }
+        std::printf("]}");
+        sep = ",\n";
+    }
+    std::printf("],\n");
+
+    std::printf("     \"locked\": [");
+    sep = "\n";
+    for (const auto& [key, days] : agg.locked) {
+        auto sym = symbol_of(key);
+        uint64_t total = 0;
+        for (auto& [day, amount] : days) {
+            total += amount;
+        }
+        std::printf("%s      {\"contract\": \"%s\", \"symbol\": \"%s\", \"total\": \"%s\", \"releases\": [", sep, name(key.code).to_string().c_str(),
+            symbol_code(key.sym).to_string().c_str(), amount_string(total, sym).c_str());
+        const char* inner = "";
+        for (auto& [day, amount] : days) {
+            std::printf("%s{\"date\": \"%s\", \"amount\": \"%s\"}", inner, date_string(day).c_str(), amount_string(amount, sym).c_str());
+            inner = ", ";
+        }
+        std::printf("]}");
+        sep = ",\n";
+    }
+    std::printf("],\n");
+
+    // one epoch's distribution over the pool it was added to, compounded over a year of epochs
+    std::printf("     \"symbols\": [");
+    sep = "\n";
+    for (const auto& [code, s] : agg.symbols) {
+        double ratio = s.issued.amount > 0 ? double(s.locked.amount) / s.issued.amount : 0;
+        int64_t base = s.locked.amount - s.distribute.amount;
+        std::printf("%s      {\"contract\": \"%s\", \"symbol\": \"%s\", \"token\": \"%s\", \"rate\": %llu, \"locked\": \"%s\", \"issued\": \"%s\", \"locked_per_issued\": %.8f, \"apy\": ",
+            sep, name(code).to_string().c_str(), s.sym.code().to_string().c_str(), s.sname.to_string().c_str(), (unsigned long long)s.rate,
+            s.locked.to_string().c_str(), s.issued.to_string().c_str(), ratio);
+        if (agg.epoch && agg.epoch->length > 0 && base > 0) {
+            double epochs_per_year = 365.0 * 86400 / agg.epoch->length;
+            std::printf("%.6f}", std::pow(1 + double(s.distribute.amount) / base, epochs_per_year) - 1);
+        } else {
+            std::printf("null}");
+        }
+        sep = ",\n";
+    }
+    std::printf("]}%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+    options opt;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && !std::strcmp(argv[i], "--threads")) {
+            opt.threads = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--now")) {
+            opt.now = std::strtoul(argv[++i], nullptr, 10);
+        } else if (i + 1 < argc && !std::strcmp(argv[i], "--top")) {
+            opt.top = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] == '-') {
+            opt.files.clear();
+            break;
+        } else {
+            opt.files.push_back(argv[i]);
+        }
+    }
+    if (opt.files.empty()) {
+        std::fprintf(stderr, "usage: %s [--threads N] [--now UNIX_SECONDS] [--top N] DUMP...\n", argv[0]);
+        return 2;
+    }
+
+    std::printf("{\n  \"now\": %u, \"threads\": %u,\n  \"snapshots\": [\n", opt.now, opt.threads);
+    for (size_t i = 0; i < opt.files.size(); i++) {
+        auto start = std::chrono::steady_clock::now();
+        auto agg = scan(opt.files[i], opt);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        print_snapshot(opt.files[i], agg, seconds, i + 1 == opt.files.size());
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
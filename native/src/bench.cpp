@@ -0,0 +1,281 @@
+#include <native/chain.hpp>
+#include <native/contracts.hpp>
+#include <native/dump.hpp>
+
+#include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace eosio;
+using eosio::native::chain;
+using eosio::native::transaction_result;
+
+/**
+ * Synthetic load for the contracts' hot actions. Every holder gets `buckets` live
+ * lock buckets on SIFT next to `symbols` staked symbols, then each measured action
+ * runs `samples` times as its own transaction. Results go to stdout as one JSON
+ * document, progress to stderr.
+ */
+
+static const name token_ift("token.ift"), issuer_ift("issuer.ift"), admin_ift("admin.ift"), staking_ift("staking.ift"), sift_ift("sift.ift"), relayer("relayer");
+static const symbol IFT("IFT", 8), SIFT("SIFT", 8);
+static const uint64_t lock_time = 3600;
+static const uint64_t epoch_length = 28800;
+
+struct options {
+    uint64_t holders = 100000;
+    uint64_t buckets = 20;
+    uint64_t symbols = 50;
+    uint64_t samples = 1000;
+    std::string dump;
+};
+
+struct stake_entry {
+    name owner;
+    asset quantity;
+    symbol_code sc;
+};
+
+struct transfer_entry {
+    name to;
+    int64_t amount;
+    std::string memo;
+};
+
+struct epoch_row {
+    uint64_t length;
+    uint64_t number;
+    uint64_t end_time;
+    asset distribute;
+    binary_extension<uint64_t> supply;
+    binary_extension<uint64_t> cursor;
+    binary_extension<uint64_t> rate;
+    binary_extension<uint64_t> growth;
+};
+
+struct sample {
+    double cpu_us;
+    int64_t ram_bytes;
+    uint64_t db_reads;
+    uint64_t db_writes;
+    uint64_t inline_actions;
+};
+
+struct report {
+    std::string action;
+    std::vector<sample> samples;
+    uint64_t failures = 0;
+    std::string last_error;
+};
+
+static void require(const transaction_result& r, const char* what) {
+    if (!r.succeeded) {
+        std::fprintf(stderr, "setup failed at %s: %s\n", what, r.error.c_str());
+        std::exit(1);
+    }
+}
+
+static void record(report& rep, const transaction_result& r) {
+    if (!r.succeeded) {
+        rep.failures++;
+        rep.last_error = r.error;
+        return;
+    }
+    int64_t ram = 0;
+    for (auto& [payer, delta] : r.ram_delta) {
+        ram += delta;
+    }
+    rep.samples.push_back({ std::chrono::duration<double, std::micro>(r.elapsed).count(), ram,
+        r.stats.db_reads, r.stats.db_writes, r.stats.inline_actions });
+}
+
+static name holder(uint64_t i) {
+    // base 31 over the name alphabet minus '.', so every holder is a distinct 12 char name
+    static const char charmap[] = "12345abcdefghijklmnopqrstuvwxyz";
+    char buffer[13] = "h11111111111";
+    for (int pos = 11; pos > 0 && i > 0; pos--) {
+        buffer[pos] = charmap[i % 31];
+        i /= 31;
+    }
+    return name(buffer);
+}
+
+static symbol extra_symbol(uint64_t i) {
+    // SA, SB, ... SZ, SAA, ...
+    std::string code = "S";
+    do {
+        code += char('A' + i % 26);
+        i /= 26;
+    } while (i > 0);
+    return symbol(symbol_code(code), 8);
+}
+
+static void stake_round(chain& c, const options& opt, int64_t amount) {
+    std::vector<stake_entry> batch;
+    batch.reserve(opt.holders);
+    for (uint64_t i = 0; i < opt.holders; i++) {
+        batch.push_back({ holder(i), asset(amount, IFT), SIFT.code() });
+    }
+    require(c.push(token_ift, name("transfer"), relayer, relayer, staking_ift, asset(amount * opt.holders, IFT), std::string("deposit")), "deposit");
+    require(c.push(staking_ift, name("stakebatch"), relayer, relayer, batch), "stakebatch");
+}
+
+static void setup(chain& c, const options& opt) {
+    for (auto n : { issuer_ift, admin_ift, relayer }) {
+        c.create_account(n);
+    }
+    for (uint64_t i = 0; i < opt.holders; i++) {
+        c.create_account(holder(i));
+    }
+    c.set_code(token_ift, ifttoken_apply);
+    c.set_code(sift_ift, stakedtoken_apply);
+    c.set_code(staking_ift, staking_apply);
+    c.grant_code(issuer_ift, staking_ift);
+
+    // the relayer stakes 1 IFT per holder and round, holders keep 1 IFT for the measured stakes
+    int64_t relayer_funds = 100000000LL * opt.buckets * opt.holders + 1000000000LL * opt.symbols;
+    int64_t holder_funds = 100000000LL;
+    require(c.push(token_ift, name("create"), token_ift, issuer_ift, asset(asset::max_amount, IFT)), "create IFT");
+    require(c.push(token_ift, name("issue"), issuer_ift, issuer_ift, asset(relayer_funds + holder_funds * opt.holders, IFT), std::string("")), "issue IFT");
+    require(c.push(token_ift, name("transfer"), issuer_ift, issuer_ift, relayer, asset(relayer_funds, IFT), std::string("")), "fund relayer");
+    for (uint64_t i = 0; i < opt.holders; i++) {
+        require(c.push(token_ift, name("transfer"), issuer_ift, issuer_ift, holder(i), asset(holder_funds, IFT), std::string("")), "fund holder");
+    }
+
+    require(c.push(staking_ift, name("init"), admin_ift, uint64_t(1), epoch_length, uint64_t(c.now().sec_since_epoch())), "init");
+    require(c.push(sift_ift, name("create"), sift_ift, staking_ift, asset(asset::max_amount, SIFT)), "create SIFT");
+    require(c.push(staking_ift, name("addsymbol"), admin_ift, SIFT, sift_ift, uint64_t(3000), lock_time), "addsymbol SIFT");
+    for (uint64_t i = 1; i < opt.symbols; i++) {
+        auto sym = extra_symbol(i - 1);
+        require(c.push(sift_ift, name("create"), sift_ift, staking_ift, asset(asset::max_amount, sym)), "create symbol");
+        require(c.push(staking_ift, name("addsymbol"), admin_ift, sym, sift_ift, uint64_t(100), lock_time), "addsymbol");
+        std::vector<stake_entry> seed { { relayer, asset(1000000000LL, IFT), sym.code() } };
+        require(c.push(token_ift, name("transfer"), relayer, relayer, staking_ift, asset(1000000000LL, IFT), std::string("deposit")), "deposit");
+        require(c.push(staking_ift, name("stakebatch"), relayer, relayer, seed), "seed symbol");
+    }
+
+    // the first round expires before the others, leaving every holder an unlocked balance
+    // and `buckets - 1` live buckets, the measured stake adds the last one
+    stake_round(c, opt, 100000000LL);
+    c.advance(seconds(lock_time + 60));
+    for (uint64_t b = 1; b < opt.buckets; b++) {
+        std::fprintf(stderr, "bucket round %llu/%llu\n", (unsigned long long)b, (unsigned long long)opt.buckets - 1);
+        stake_round(c, opt, 100000000LL);
+        c.advance(seconds(60));
+    }
+}
+
+static void print_stats(const report& rep, bool last) {
+    auto values = [&](auto field) {
+        std::vector<double> v;
+        for (auto& s : rep.samples) {
+            v.push_back(double(s.*field));
+        }
+        std::sort(v.begin(), v.end());
+        return v;
+    };
+    auto mean = [](const std::vector<double>& v) {
+        double sum = 0;
+        for (auto x : v) {
+            sum += x;
+        }
+        return v.empty() ? 0 : sum / v.size();
+    };
+    auto pct = [](const std::vector<double>& v, double p) {
+        return v.empty() ? 0 : v[std::min(v.size() - 1, size_t(p * v.size()))];
+    };
+    auto cpu = values(&sample::cpu_us);
+    std::printf("    {\"action\": \"%s\", \"samples\": %zu, \"failures\": %llu, ", rep.action.c_str(), rep.samples.size(), (unsigned long long)rep.failures);
+    std::printf("\"cpu_us\": {\"mean\": %.2f, \"p50\": %.2f, \"p99\": %.2f, \"max\": %.2f}, ", mean(cpu), pct(cpu, 0.5), pct(cpu, 0.99), cpu.empty() ? 0 : cpu.back());
+    std::printf("\"ram_bytes\": %.1f, \"db_reads\": %.1f, \"db_writes\": %.1f, \"inline_actions\": %.1f",
+        mean(values(&sample::ram_bytes)), mean(values(&sample::db_reads)), mean(values(&sample::db_writes)), mean(values(&sample::inline_actions)));
+    if (rep.failures > 0) {
+        std::printf(", \"last_error\": \"%s\"", rep.last_error.c_str());
+    }
+    std::printf("}%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv) {
+    options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        uint64_t value = std::strtoull(argv[i + 1], nullptr, 10);
+        if (!std::strcmp(argv[i], "--dump")) {
+            opt.dump = argv[i + 1];
+        } else if (!std::strcmp(argv[i], "--holders")) {
+            opt.holders = value;
+        } else if (!std::strcmp(argv[i], "--buckets")) {
+            opt.buckets = value;
+        } else if (!std::strcmp(argv[i], "--symbols")) {
+            opt.symbols = value;
+        } else if (!std::strcmp(argv[i], "--samples")) {
+            opt.samples = value;
+        } else {
+            std::fprintf(stderr, "usage: %s [--holders N] [--buckets N] [--symbols N] [--samples N] [--dump FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (opt.holders < 2 || opt.buckets < 1 || opt.buckets > 20 || opt.symbols < 1) {
+        std::fprintf(stderr, "need at least 2 holders, 1 to 20 buckets and 1 symbol\n");
+        return 2;
+    }
+    opt.samples = std::min(opt.samples, opt.holders / 2);
+
+    chain c;
+    setup(c, opt);
+
+    std::vector<report> reports = { { "stake" }, { "transfer_locked" }, { "transfers_locked_10" }, { "unstake" }, { "unstake_burn" }, { "distribute" } };
+
+    // the sampled holders are the first `samples`, the transfers send to the next ones,
+    // whose newest bucket matches the release time so it is merged instead of added
+    std::fprintf(stderr, "measuring\n");
+    for (uint64_t i = 0; i < opt.samples * 2; i++) {
+        auto r = c.push(token_ift, name("transfer"), holder(i), holder(i), staking_ift, asset(50000000LL, IFT), std::string("SIFT"));
+        if (i < opt.samples) {
+            record(reports[0], r);
+        }
+    }
+    for (uint64_t i = 0; i < opt.samples; i++) {
+        record(reports[1], c.push(sift_ift, name("transfer"), holder(i), holder(i), holder(opt.samples + i), asset(1000000LL, SIFT), std::string("")));
+    }
+    for (uint64_t i = 0; i < opt.samples; i++) {
+        std::vector<transfer_entry> batch;
+        for (uint64_t j = 0; j < 10; j++) {
+            batch.push_back({ holder(opt.samples + (i + j) % opt.samples), 100000LL, "" });
+        }
+        record(reports[2], c.push(sift_ift, name("transfers"), holder(i), holder(i), SIFT, batch));
+    }
+    for (uint64_t i = 0; i < opt.samples; i++) {
+        record(reports[3], c.push(sift_ift, name("transfer"), holder(i), holder(i), staking_ift, asset(1000000LL, SIFT), std::string("")));
+    }
+    for (uint64_t i = 0; i < opt.samples; i++) {
+        record(reports[4], c.push(staking_ift, name("unstakeburn"), holder(i), holder(i), asset(1000000LL, SIFT)));
+    }
+
+    // every page of an epoch-crossing distribution is one sample
+    for (uint64_t i = 0; i < std::max<uint64_t>(opt.samples / 10, 1); i++) {
+        c.advance(seconds(epoch_length));
+        do {
+            record(reports[5], c.push(staking_ift, name("distribute"), admin_ift));
+        } while (c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value)->cursor.value_or(0) != 0
+            && reports[5].failures == 0);
+    }
+
+    // the state after the measured actions, input for analytics
+    if (!opt.dump.empty()) {
+        eosio::native::write_dump(c, opt.dump);
+    }
+
+    std::printf("{\n  \"config\": {\"holders\": %llu, \"buckets\": %llu, \"symbols\": %llu, \"samples\": %llu},\n  \"results\": [\n",
+        (unsigned long long)opt.holders, (unsigned long long)opt.buckets, (unsigned long long)opt.symbols, (unsigned long long)opt.samples);
+    for (size_t i = 0; i < reports.size(); i++) {
+        print_stats(reports[i], i + 1 == reports.size());
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,441 @@
+#include <native/chain.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace eosio::native {
+
+    namespace {
+        chain* active_chain = nullptr;
+
+        constexpr int64_t secondary_billable(uint8_t width) {
+            return width == 16 ? billable_size::index128 : billable_size::index64;
+        }
+
+        int64_t row_billable(const db_row& row) {
+            int64_t bytes = billable_size::key_value + int64_t(row.data.size());
+            for (const auto& k : row.keys) {
+                bytes += secondary_billable(k.width);
+            }
+            return bytes;
+        }
+    }
+
+    chain::chain() {
+        check(active_chain == nullptr, "only one native chain may be active at a time");
+        active_chain = this;
+        _now = time_point(seconds(1640995200));
+    }
+
+    chain::~chain() {
+        active_chain = nullptr;
+    }
+
+    chain& chain::active() {
+        check(active_chain != nullptr, "no native chain is active");
+        return *active_chain;
+    }
+
+    void chain::create_account(name account) {
+        _accounts.insert(account);
+    }
+
+    bool chain::is_account(name account) const {
+        return _accounts.count(account) > 0;
+    }
+
+    void chain::set_code(name account, apply_handler handler) {
+        create_account(account);
+        _code[account] = handler;
+    }
+
+    void chain::grant_code(name account, name code) {
+        _code_grants.emplace(account, code);
+    }
+
+    int64_t chain::ram_usage(name account) const {
+        auto itr = _ram.find(account);
+        return itr == _ram.end() ? 0 : itr->second;
+    }
+
+    const db_table* chain::find_table(name code, uint64_t scope, name table) const {
+        auto itr = _tables.find({ code.value, scope, table.value });
+        return itr == _tables.end() ? nullptr : &itr->second;
+    }
+
+    chain::apply_context& chain::context() {
+        check(!_contexts.empty(), "host function called outside of an action");
+        return *_contexts.back();
+    }
+
+    transaction_result chain::push_action(name account, name act, std::vector<permission_level> auth, std::vector<char> data, bool read_only) {
+        check(!_in_transaction, "nested transactions are not supported");
+        transaction_result result;
+
+        action a;
+        a.account = account;
+        a.name = act;
+        a.authorization = std::move(auth);
+        a.data = std::move(data);
+
+        _in_transaction = true;
+        _read_only = read_only;
+        _undo.clear();
+        _ram_delta.clear();
+        _return_value.clear();
+        _stats = {};
+
+        auto start = std::chrono::steady_clock::now();
+        try {
+            execute(a, 0, result.traces);
+            result.succeeded = true;
+            result.return_value = std::move(_return_value);
+        } catch (const eosio_assert_failure& e) {
+            result.error = e.what();
+        }
+        result.elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!result.succeeded) {
+            for (auto& [id, saved] : _undo) {
+                if (saved) {
+                    _tables[id] = std::move(*saved);
+                } else {
+                    _tables.erase(id);
+                }
+            }
+            for (auto& [payer, delta] : _ram_delta) {
+                _ram[payer] -= delta;
+            }
+            _ram_delta.clear();
+            result.return_value.clear();
+        }
+
+        result.stats = _stats;
+        result.ram_delta = _ram_delta;
+        _contexts.clear();
+        _undo.clear();
+        _in_transaction = false;
+        _read_only = false;
+        return result;
+    }
+
+    void chain::execute(const action& act, uint32_t depth, std::vector<action_trace>& traces) {
+        check(depth < 16, "max inline action depth exceeded");
+
+        apply_context ctx;
+        ctx.act = &act;
+        ctx.notified.push_back(act.account);
+        _contexts.push_back(&ctx);
+
+        for (size_t i = 0; i < ctx.notified.size(); ++i) {
+            ctx.receiver = ctx.notified[i];
+            traces.push_back({ ctx.receiver, act.account, act.name, depth });
+            _stats.actions++;
+            if (i > 0) {
+                _stats.notifications++;
+            }
+            auto code = _code.find(ctx.receiver);
+            ctx.ram_delta.clear();
+            if (code != _code.end()) {
+                code->second(ctx.receiver.value, act.account.value, act.name.value);
+            }
+            for (const auto& [payer, delta] : ctx.ram_delta) {
+                if (delta <= 0 || payer == ctx.receiver) {
+                    continue;
+                }
+                check(i == 0, "cannot increase RAM usage of " + payer.to_string() + " within a notification to " + ctx.receiver.to_string());
+                bool authorized = std::any_of(act.authorization.begin(), act.authorization.end(), [&](const auto& p) { return p.actor == payer; });
+                check(authorized, "cannot increase RAM usage of " + payer.to_string() + " who has not authorized " + act.account.to_string() + "::" + act.name.to_string());
+            }
+        }
+
+        auto return_value = std::move(ctx.return_value);
+        auto inlines = std::move(ctx.inlines);
+        _contexts.pop_back();
+
+        for (const auto& p : inlines) {
+            for (const auto& level : p.act.authorization) {
+                check(level.actor == p.sender || _code_grants.count({ level.actor, p.sender }),
+                      "missing authority of " + level.actor.to_string() + " for inline action sent by " + p.sender.to_string());
+            }
+            _stats.inline_actions++;
+            execute(p.act, depth + 1, traces);
+        }
+
+        if (depth == 0) {
+            _return_value = std::move(return_value);
+        }
+    }
+
+    db_table* chain::writable_table(uint64_t scope, uint64_t table, bool create) {
+        check(!_read_only, "database write in a read-only transaction");
+        auto receiver = context().receiver;
+        table_id id { receiver.value, scope, table };
+        auto itr = _tables.find(id);
+        if (!_undo.count(id)) {
+            if (itr == _tables.end()) {
+                _undo.emplace(id, std::nullopt);
+            } else {
+                _undo.emplace(id, itr->second);
+            }
+        }
+        if (itr == _tables.end()) {
+            if (!create) {
+                return nullptr;
+            }
+            itr = _tables.emplace(id, db_table {}).first;
+        }
+        _stats.db_writes++;
+        return &itr->second;
+    }
+
+    const db_table* chain::readable_table(uint64_t code, uint64_t scope, uint64_t table) {
+        _stats.db_reads++;
+        auto itr = _tables.find({ code, scope, table });
+        return itr == _tables.end() ? nullptr : &itr->second;
+    }
+
+    void chain::bill(name payer, int64_t bytes) {
+        _ram[payer] += bytes;
+        _ram_delta[payer] += bytes;
+        context().ram_delta[payer] += bytes;
+    }
+
+    void chain::drop_table_if_empty(uint64_t scope, uint64_t table) {
+        table_id id { context().receiver.value, scope, table };
+        auto itr = _tables.find(id);
+        if (itr != _tables.end() && itr->second.rows.empty()) {
+            bill(itr->second.payer, -billable_size::table_id);
+            _tables.erase(itr);
+        }
+    }
+
+}
+
+namespace eosio::native {
+    void print_console(std::string_view) {}
+}
+
+namespace eosio::internal_use_do_not_use {
+
+    using native::chain;
+
+    uint32_t read_action_data(void* msg, uint32_t len) {
+        const auto& data = chain::active().context().act->data;
+        auto copy = std::min<size_t>(len, data.size());
+        if (copy) {
+            std::memcpy(msg, data.data(), copy);
+        }
+        return uint32_t(copy);
+    }
+
+    uint32_t action_data_size() {
+        return uint32_t(chain::active().context().act->data.size());
+    }
+
+    void require_recipient(uint64_t n) {
+        auto& ctx = chain::active().context();
+        auto account = name(n);
+        check(chain::active().is_account(account), "recipient account does not exist");
+        if (std::find(ctx.notified.begin(), ctx.notified.end(), account) == ctx.notified.end()) {
+            ctx.notified.push_back(account);
+        }
+    }
+
+    bool has_auth(uint64_t n) {
+        const auto& auths = chain::active().context().act->authorization;
+        return std::any_of(auths.begin(), auths.end(), [&](const auto& p) { return p.actor.value == n; });
+    }
+
+    void require_auth(uint64_t n) {
+        check(has_auth(n), "missing authority of " + name(n).to_string());
+    }
+
+    void require_auth2(uint64_t n, uint64_t permission) {
+        const auto& auths = chain::active().context().act->authorization;
+        bool found = std::any_of(auths.begin(), auths.end(), [&](const auto& p) {
+            return p.actor.value == n && p.permission.value == permission;
+        });
+        check(found, "missing authority of " + name(n).to_string() + "@" + name(permission).to_string());
+    }
+
+    bool is_account(uint64_t n) {
+        return chain::active().is_account(name(n));
+    }
+
+    void send_inline(char* serialized_action, size_t size) {
+        auto& ctx = chain::active().context();
+        ctx.inlines.push_back({ ctx.receiver, unpack<action>(serialized_action, size) });
+    }
+
+    uint64_t current_time() {
+        return uint64_t(chain::active().now().time_since_epoch().count());
+    }
+
+    uint64_t current_receiver() {
+        return chain::active().context().receiver.value;
+    }
+
+    void set_action_return_value(void* return_value, size_t size) {
+        auto& ctx = chain::active().context();
+        ctx.return_value.assign((const char*)return_value, (const char*)return_value + size);
+    }
+
+}
+
+namespace eosio::native::db {
+
+    namespace {
+        const db_table* readable(uint64_t code, uint64_t scope, uint64_t table) {
+            return chain::active().readable_table(code, scope, table);
+        }
+    }
+
+    const std::vector<char>* find(uint64_t code, uint64_t scope, uint64_t table, uint64_t pk) {
+        auto t = readable(code, scope, table);
+        if (!t) {
+            return nullptr;
+        }
+        auto itr = t->rows.find(pk);
+        return itr == t->rows.end() ? nullptr : &itr->second.data;
+    }
+
+    std::optional<uint64_t> lower_bound(uint64_t code, uint64_t scope, uint64_t table, uint64_t pk) {
+        auto t = readable(code, scope, table);
+        if (!t) {
+            return std::nullopt;
+        }
+        auto itr = t->rows.lower_bound(pk);
+        return itr == t->rows.end() ? std::nullopt : std::optional<uint64_t>(itr->first);
+    }
+
+    std::optional<uint64_t> upper_bound(uint64_t code, uint64_t scope, uint64_t table, uint64_t pk) {
+        auto t = readable(code, scope, table);
+        if (!t) {
+            return std::nullopt;
+        }
+        auto itr = t->rows.upper_bound(pk);
+        return itr == t->rows.end() ? std::nullopt : std::optional<uint64_t>(itr->first);
+    }
+
+    std::optional<uint64_t> previous(uint64_t code, uint64_t scope, uint64_t table, uint64_t pk) {
+        auto t = readable(code, scope, table);
+        if (!t) {
+            return std::nullopt;
+        }
+        auto itr = t->rows.lower_bound(pk);
+        if (itr == t->rows.begin()) {
+            return std::nullopt;
+        }
+        return (--itr)->first;
+    }
+
+    std::optional<uint64_t> last(uint64_t code, uint64_t scope, uint64_t table) {
+        auto t = readable(code, scope, table);
+        if (!t || t->rows.empty()) {
+            return std::nullopt;
+        }
+        return t->rows.rbegin()->first;
+    }
+
+    void store(uint64_t scope, uint64_t table, uint64_t payer, uint64_t pk, std::vector<char> data, std::vector<secondary_entry> keys) {
+        auto& c = chain::active();
+        check(c.is_account(name(payer)), "ram payer account does not exist");
+        auto t = c.writable_table(scope, table, true);
+        check(!t->rows.count(pk), "could not insert object, most likely a uniqueness constraint was violated");
+        if (t->rows.empty()) {
+            t->payer = name(payer);
+            c.bill(name(payer), billable_size::table_id);
+        }
+        db_row row { name(payer), std::move(data), std::move(keys) };
+        row.billed = row_billable(row);
+        for (size_t i = 0; i < row.keys.size(); ++i) {
+            t->indexes[i].emplace(row.keys[i].key, pk);
+        }
+        c.bill(row.payer, row.billed);
+        t->rows.emplace(pk, std::move(row));
+    }
+
+    void update(uint64_t scope, uint64_t table, uint64_t payer, uint64_t pk, std::vector<char> data, std::vector<secondary_entry> keys) {
+        auto& c = chain::active();
+        auto t = c.writable_table(scope, table, false);
+        check(t != nullptr && t->rows.count(pk), "could not modify object, it does not exist");
+        auto& row = t->rows[pk];
+        for (size_t i = 0; i < row.keys.size(); ++i) {
+            t->indexes[i].erase({ row.keys[i].key, pk });
+        }
+        c.bill(row.payer, -row.billed);
+        if (payer != 0) {
+            check(c.is_account(name(payer)), "ram payer account does not exist");
+            row.payer = name(payer);
+        }
+        row.data = std::move(data);
+        row.keys = std::move(keys);
+        row.billed = row_billable(row);
+        for (size_t i = 0; i < row.keys.size(); ++i) {
+            t->indexes[i].emplace(row.keys[i].key, pk);
+        }
+        c.bill(row.payer, row.billed);
+    }
+
+    void remove(uint64_t scope, uint64_t table, uint64_t pk) {
+        auto& c = chain::active();
+        auto t = c.writable_table(scope, table, false);
+        check(t != nullptr && t->rows.count(pk), "could not erase object, it does not exist");
+        auto itr = t->rows.find(pk);
+        for (size_t i = 0; i < itr->second.keys.size(); ++i) {
+            t->indexes[i].erase({ itr->second.keys[i].key, pk });
+        }
+        c.bill(itr->second.payer, -itr->second.billed);
+        t->rows.erase(itr);
+        c.drop_table_if_empty(scope, table);
+    }
+
+    std::optional<secondary_position> idx_lower_bound(uint64_t code, uint64_t scope, uint64_t table, uint32_t index, secondary_key key) {
+        auto t = readable(code, scope, table);
+        if (!t) {
+            return std::nullopt;
+        }
+        auto itr = t->indexes[index].lower_bound({ key, 0 });
+        return itr == t->indexes[index].end() ? std::nullopt : std::optional<secondary_position>(*itr);
+    }
+
+    std::optional<secondary_position> idx_upper_bound(uint64_t code, uint64_t scope, uint64_t table, uint32_t index, secondary_key key) {
+        auto t = readable(code, scope, table);
+        if (!t) {
+            return std::nullopt;
+        }
+        auto itr = t->indexes[index].upper_bound({ key, UINT64_MAX });
+        return itr == t->indexes[index].end() ? std::nullopt : std::optional<secondary_position>(*itr);
+    }
+
+    std::optional<secondary_position> idx_next(uint64_t code, uint64_t scope, uint64_t table, uint32_t index, secondary_position pos) {
+        auto t = readable(code, scope, table);
+        if (!t) {
+            return std::nullopt;
+        }
+        auto itr = t->indexes[index].upper_bound(pos);
+        return itr == t->indexes[index].end() ? std::nullopt : std::optional<secondary_position>(*itr);
+    }
+
+    std::optional<secondary_position> idx_previous(uint64_t code, uint64_t scope, uint64_t table, uint32_t index, secondary_position pos) {
+        auto t = readable(code, scope, table);
+        if (!t) {
+            return std::nullopt;
+        }
+        auto itr = t->indexes[index].lower_bound(pos);
+        if (itr == t->indexes[index].begin()) {
+            return std::nullopt;
+        }
+        return *(--itr);
+    }
+
+    std::optional<secondary_position> idx_last(uint64_t code, uint64_t scope, uint64_t table, uint32_t index) {
+        auto t = readable(code, scope, table);
+        if (!t || t->indexes[index].empty()) {
+            return std::nullopt;
+        }
+        return *t->indexes[index].rbegin();
+    }
+
+}
@@ -0,0 +1,9 @@
+#include <eosio/eosio.hpp>
+#include <native/contracts.hpp>
+
+#include <ifttoken.hpp>
+
+// ifttoken defines its own apply, give it the name the chain registers
+#define apply ifttoken_apply
+#include <ifttoken.cpp>
+#undef apply
@@ -0,0 +1,9 @@
+#include <eosio/eosio.hpp>
+#include <native/contracts.hpp>
+
+#include <stakedtoken.hpp>
+
+// stakedtoken defines its own apply, give it the name the chain registers
+#define apply stakedtoken_apply
+#include <stakedtoken.cpp>
+#undef apply
@@ -0,0 +1,10 @@
+#include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+#include <native/contracts.hpp>
+
+#include <staking.hpp>
+
+// staking defines its own apply, give it the name the chain registers
+#define apply staking_apply
+#include <staking.cpp>
+#undef apply
@@ -0,0 +1,44 @@
+#include <native/dump.hpp>
+
+#include <cstdio>
+#include <stdexcept>
+
+namespace eosio::native {
+
+    void write_dump(const chain& c, const std::string& path) {
+        bool json = path.size() >= 6 && path.compare(path.size() - 6, 6, ".jsonl") == 0;
+        std::FILE* out = std::fopen(path.c_str(), "wb");
+        if (!out) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        if (!json) {
+            std::fwrite(dump_magic, 1, sizeof(dump_magic), out);
+        }
+        static const char hex[] = "0123456789abcdef";
+        std::string line;
+        for (const auto& [id, table] : c.tables()) {
+            for (const auto& [pk, row] : table.rows) {
+                if (json) {
+                    line = "{\"code\":\"" + name(id.code).to_string() + "\",\"scope\":\"" + name(id.scope).to_string()
+                        + "\",\"table\":\"" + name(id.table).to_string() + "\",\"primary_key\":" + std::to_string(pk) + ",\"data\":\"";
+                    for (unsigned char b : row.data) {
+                        line += hex[b >> 4];
+                        line += hex[b & 15];
+                    }
+                    line += "\"}\n";
+                    std::fwrite(line.data(), 1, line.size(), out);
+                } else {
+                    uint64_t keys[4] = { id.code, id.scope, id.table, pk };
+                    uint32_t size = row.data.size();
+                    std::fwrite(keys, 1, sizeof(keys), out);
+                    std::fwrite(&size, 1, sizeof(size), out);
+                    std::fwrite(row.data.data(), 1, row.data.size(), out);
+                }
+            }
+        }
+        if (std::fclose(out) != 0) {
+            throw std::runtime_error("cannot write " + path);
+        }
+    }
+
+}
@@ -0,0 +1,156 @@
+#include <native/chain.hpp>
+
+#include <stakedtoken.hpp>
+#include <staking.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace eosio;
+using eosio::native::billable_size;
+
+/**
+ * RAM projection for the three contracts. Row sizes are the packed sizes of the
+ * contracts' own table structs plus the per-row, secondary-index and table overhead
+ * nodeos bills (native::billable_size). Holder counts grow linearly over `--days`;
+ * each holder keeps `--symbols-per-holder` staked symbols and receives locked tokens
+ * `--receives-per-day` times per symbol, which sets how many lock buckets it holds.
+ * Results go to stdout as one JSON document.
+ */
+
+struct options {
+    uint64_t holders = 100000;
+    double new_holders = 0;
+    uint64_t days = 365;
+    uint64_t step = 30;
+    uint64_t symbols = 50;
+    uint64_t symbols_per_holder = 1;
+    double receives_per_day = 1;
+    uint64_t lock_time = 86400;
+    uint32_t granularity = 0;
+    uint64_t relayers = 0;
+};
+
+static const name token_ift("token.ift"), sift_ift("sift.ift"), staking_ift("staking.ift");
+
+// billed bytes of one row, its packed size plus the per-row and secondary index overhead
+template<typename T>
+static int64_t row_bytes(const T& row, int secondary64 = 0) {
+    return int64_t(pack_size(row)) + billable_size::key_value + secondary64 * billable_size::index64;
+}
+
+struct table_estimate {
+    name contract;
+    std::string table;
+    name payer;
+    double rows;
+    double bytes;
+};
+
+int main(int argc, char** argv) {
+    options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* arg = argv[i];
+        const char* value = argv[i + 1];
+        if (!std::strcmp(arg, "--holders")) {
+            opt.holders = std::strtoull(value, nullptr, 10);
+        } else if (!std::strcmp(arg, "--new-holders")) {
+            opt.new_holders = std::strtod(value, nullptr);
+        } else if (!std::strcmp(arg, "--days")) {
+            opt.days = std::strtoull(value, nullptr, 10);
+        } else if (!std::strcmp(arg, "--step")) {
+            opt.step = std::max<uint64_t>(std::strtoull(value, nullptr, 10), 1);
+        } else if (!std::strcmp(arg, "--symbols")) {
+            opt.symbols = std::strtoull(value, nullptr, 10);
+        } else if (!std::strcmp(arg, "--symbols-per-holder")) {
+            opt.symbols_per_holder = std::strtoull(value, nullptr, 10);
+        } else if (!std::strcmp(arg, "--receives-per-day")) {
+            opt.receives_per_day = std::strtod(value, nullptr);
+        } else if (!std::strcmp(arg, "--lock-time")) {
+            opt.lock_time = std::strtoull(value, nullptr, 10);
+        } else if (!std::strcmp(arg, "--granularity")) {
+            opt.granularity = std::strtoul(value, nullptr, 10);
+        } else if (!std::strcmp(arg, "--relayers")) {
+            opt.relayers = std::strtoull(value, nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--holders N] [--new-holders N_PER_DAY] [--days N] [--step DAYS] [--symbols N] [--symbols-per-holder N] "
+                "[--receives-per-day X] [--lock-time SECONDS] [--granularity SECONDS] [--relayers N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (opt.symbols < 1 || opt.symbols_per_holder < 1 || opt.symbols_per_holder > opt.symbols) {
+        std::fprintf(stderr, "need at least 1 symbol and 1 to --symbols symbols per holder\n");
+        return 2;
+    }
+    uint32_t granularity = opt.granularity > 0 ? opt.granularity : token::lock_granularity(opt.lock_time);
+
+    // representative rows, every size but the lock pack's is fixed
+    token::account account { asset(0, symbol("SIFT", 8)) };
+    token::currency_stats ift_stat { asset(0, symbol("IFT", 8)), asset(0, symbol("IFT", 8)), name("issuer.ift") };
+    token::currency_stats sift_stat { asset(0, symbol("SIFT", 8)), asset(0, symbol("SIFT", 8)), staking_ift };
+    sift_stat.lock_time = opt.lock_time;
+    sift_stat.lock_granularity = granularity;
+    token::st_lock lock { 0, block_timestamp(), symbol_code("SIFT"), 0 };
+    token::st_lockpack empty_pack { symbol_code("SIFT"), 0, block_timestamp(), {} };
+    token::st_lockpack one_pack = empty_pack;
+    one_pack.buckets.push_back({ block_timestamp(), 0 });
+    staking::st_symbol sym { symbol("SIFT", 8), sift_ift, 0, 0, asset(), asset(), asset(), fixedmath::one, fixedmath::one };
+    staking::epoch epoch { 0, 0, 0, asset(), 0, 0, 0, 0, 0 };
+    staking::deposit deposit { name(), asset() };
+
+    int64_t pack_base = row_bytes(empty_pack);
+    int64_t pack_per_bucket = row_bytes(one_pack) - pack_base;
+
+    // a holder receiving at rate r has its release times rounded into ceil(lock_time / granularity)
+    // live slots, each taken with probability 1 - e^(-r * granularity), never more than the cap
+    double slots = std::ceil(double(opt.lock_time) / granularity);
+    double rate = opt.receives_per_day / 86400;
+    double buckets = std::min<double>(slots * (1 - std::exp(-rate * granularity)), token::MAX_LOCK_BUCKETS);
+
+    std::printf("{\n  \"config\": {\"holders\": %llu, \"new_holders\": %g, \"days\": %llu, \"symbols\": %llu, \"symbols_per_holder\": %llu, "
+        "\"receives_per_day\": %g, \"lock_time\": %llu, \"granularity\": %u, \"relayers\": %llu},\n",
+        (unsigned long long)opt.holders, opt.new_holders, (unsigned long long)opt.days, (unsigned long long)opt.symbols,
+        (unsigned long long)opt.symbols_per_holder, opt.receives_per_day, (unsigned long long)opt.lock_time, granularity, (unsigned long long)opt.relayers);
+    std::printf("  \"row_bytes\": {\"account\": %lld, \"ift_stat\": %lld, \"sift_stat\": %lld, \"lockpack_base\": %lld, \"lockpack_per_bucket\": %lld, "
+        "\"legacy_lock\": %lld, \"symbol\": %lld, \"epoch\": %lld, \"deposit\": %lld, \"table\": %lld},\n",
+        (long long)row_bytes(account), (long long)row_bytes(ift_stat), (long long)row_bytes(sift_stat), (long long)pack_base, (long long)pack_per_bucket,
+        (long long)row_bytes(lock, 1), (long long)row_bytes(sym), (long long)row_bytes(epoch), (long long)row_bytes(deposit), (long long)billable_size::table_id);
+    std::printf("  \"lock_buckets_per_holder\": %.3f,\n  \"projection\": [\n", buckets);
+
+    for (uint64_t day = 0; day <= opt.days; day += opt.step) {
+        double holders = opt.holders + opt.new_holders * day;
+        double staked = holders * opt.symbols_per_holder;
+        double table = billable_size::table_id;
+        // the SIFT account and lock pack rows are created by staking's inline transfer, which staking pays for
+        std::vector<table_estimate> tables = {
+            { token_ift, "accounts", name("users"), holders, holders * (row_bytes(account) + table) },
+            { token_ift, "stat", token_ift, 1, double(row_bytes(ift_stat)) + table },
+            { sift_ift, "accounts", staking_ift, staked, staked * row_bytes(account) + holders * table },
+            { sift_ift, "lockpacks", staking_ift, staked, staked * (pack_base + buckets * pack_per_bucket) + holders * table },
+            { sift_ift, "stat", sift_ift, double(opt.symbols), opt.symbols * (row_bytes(sift_stat) + table) },
+            { staking_ift, "symbols", staking_ift, double(opt.symbols), opt.symbols * row_bytes(sym) + table },
+            { staking_ift, "epoch", staking_ift, 1, double(row_bytes(epoch)) + table },
+            { staking_ift, "deposits", staking_ift, double(opt.relayers), opt.relayers * row_bytes(deposit) + (opt.relayers ? table : 0) },
+        };
+        // the one row per bucket layout the lock packs replaced, with its bysym index
+        double legacy = staked * buckets * row_bytes(lock, 1) + holders * table;
+
+        std::printf("    {\"day\": %llu, \"holders\": %.0f, \"tables\": [", (unsigned long long)day, holders);
+        double payers[3] = { 0, 0, 0 };
+        for (size_t i = 0; i < tables.size(); i++) {
+            const auto& t = tables[i];
+            std::printf("%s{\"contract\": \"%s\", \"table\": \"%s\", \"payer\": \"%s\", \"rows\": %.0f, \"bytes\": %.0f}", i ? ", " : "",
+                t.contract.to_string().c_str(), t.table.c_str(), t.payer.to_string().c_str(), t.rows, t.bytes);
+            payers[t.payer == staking_ift ? 0 : t.payer == name("users") ? 1 : 2] += t.bytes;
+        }
+        std::printf("],\n     \"payers\": {\"staking.ift\": %.0f, \"users\": %.0f, \"token contracts\": %.0f}, \"total\": %.0f, \"legacy_locks\": %.0f}%s\n",
+            payers[0], payers[1], payers[2], payers[0] + payers[1] + payers[2], legacy, day + opt.step > opt.days ? "" : ",");
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,360 @@
+#include <native/chain.hpp>
+#include <native/contracts.hpp>
+
+#include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
+
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace eosio;
+using eosio::native::chain;
+
+static const name token_ift("token.ift"), issuer_ift("issuer.ift"), admin_ift("admin.ift"), staking_ift("staking.ift"), sift_ift("sift.ift");
+static const symbol IFT("IFT", 8), SIFT("SIFT", 8);
+
+struct account_row { asset balance; };
+struct transfer_entry { name to; int64_t amount; std::string memo; };
+struct lock_bucket { block_timestamp release_time; uint64_t amount; };
+struct stat_row { asset supply; asset max_supply; name issuer; binary_extension<uint64_t> lock_time; binary_extension<uint32_t> lock_granularity; };
+struct symbol_row { symbol sym; name sname; uint64_t rate; uint64_t lock_time; asset distribute; asset locked; asset issued; };
+struct epoch_row {
+    uint64_t length;
+    uint64_t number;
+    uint64_t end_time;
+    asset distribute;
+    binary_extension<uint64_t> supply;
+    binary_extension<uint64_t> cursor;
+    binary_extension<uint64_t> rate;
+    binary_extension<uint64_t> growth;
+    binary_extension<uint64_t> unminted;
+};
+struct deposit_row { name owner; asset balance; };
+struct lockpack_row { symbol_code sym; uint64_t locked_total; block_timestamp earliest; std::vector<lock_bucket> buckets; };
+
+static int failures = 0;
+
+// stands in for the stakedtoken build that kept one `locks` row per bucket, billed to whoever paid the credit
+static void seed_legacy_lock(uint64_t receiver, uint64_t code, uint64_t action) {
+    std::vector<char> data(internal_use_do_not_use::action_data_size());
+    internal_use_do_not_use::read_action_data(data.data(), data.size());
+    auto [owner, payer, row] = unpack<std::tuple<name, name, std::tuple<uint64_t, block_timestamp, symbol_code, uint64_t>>>(data);
+    native::db::store(owner.value, name("locks").value, payer.value, std::get<0>(row), pack(row), { { 8, std::get<2>(row).raw() } });
+}
+
+// stands in for a stat row written before setlock, without the lock time extensions
+static void clear_lock_time(uint64_t receiver, uint64_t code, uint64_t action) {
+    std::vector<char> data(internal_use_do_not_use::action_data_size());
+    internal_use_do_not_use::read_action_data(data.data(), data.size());
+    auto sym = unpack<symbol_code>(data);
+    auto st = unpack<stat_row>(*native::db::find(receiver, sym.raw(), name("stat").value, sym.raw()));
+    native::db::update(sym.raw(), name("stat").value, 0, sym.raw(), pack(std::make_tuple(st.supply, st.max_supply, st.issuer)), {});
+}
+
+static void expect(const native::transaction_result& r, const char* what) {
+    if (!r.succeeded) {
+        std::printf("FAILED %s: %s\n", what, r.error.c_str());
+        failures++;
+    } else {
+        std::printf("ok %s: actions=%llu inline=%llu reads=%llu writes=%llu\n", what,
+            (unsigned long long)r.stats.actions, (unsigned long long)r.stats.inline_actions,
+            (unsigned long long)r.stats.db_reads, (unsigned long long)r.stats.db_writes);
+    }
+}
+
+static void expect_fail(const native::transaction_result& r, const char* what) {
+    if (r.succeeded) {
+        std::printf("FAILED %s: succeeded\n", what);
+        failures++;
+    } else {
+        std::printf("ok %s rejected: %s\n", what, r.error.c_str());
+    }
+}
+
+static void expect_eq(int64_t actual, int64_t expected, const char* what) {
+    if (actual != expected) {
+        std::printf("FAILED %s: %lld, expected %lld\n", what, (long long)actual, (long long)expected);
+        failures++;
+    } else {
+        std::printf("ok %s: %lld\n", what, (long long)actual);
+    }
+}
+
+static asset balance(chain& c, name contract, name owner, symbol sym) {
+    auto row = c.get_row<account_row>(contract, owner.value, name("accounts"), sym.code().raw());
+    return row ? row->balance : asset(0, sym);
+}
+
+// staking.ift holds exactly the IFT locked in every pool and the relayer deposits
+static void expect_pools(chain& c, const char* what) {
+    int64_t held = 0;
+    for (auto table : { name("symbols"), name("deposits") }) {
+        auto t = c.find_table(staking_ift, staking_ift.value, table);
+        if (!t) {
+            continue;
+        }
+        for (const auto& [pk, row] : t->rows) {
+            held += table == name("symbols") ? unpack<symbol_row>(row.data).locked.amount : unpack<deposit_row>(row.data).balance.amount;
+        }
+    }
+    expect_eq(balance(c, token_ift, staking_ift, IFT).amount, held, what);
+}
+
+static void stake_and_unstake() {
+    chain c;
+    for (auto n : { issuer_ift, admin_ift, name("alice"), name("bob"), name("carol") }) {
+        c.create_account(n);
+    }
+    c.set_code(token_ift, ifttoken_apply);
+    c.set_code(sift_ift, stakedtoken_apply);
+    c.set_code(staking_ift, staking_apply);
+    c.grant_code(issuer_ift, staking_ift);
+
+    expect(c.push(token_ift, name("create"), token_ift, issuer_ift, asset(10000000000000000LL, IFT)), "create IFT");
+    expect(c.push(token_ift, name("issue"), issuer_ift, issuer_ift, asset(100000000000000LL, IFT), std::string("init")), "issue IFT");
+    expect(c.push(token_ift, name("transfer"), issuer_ift, issuer_ift, name("alice"), asset(1000000000000LL, IFT), std::string("")), "fund alice");
+    expect(c.push(token_ift, name("transfer"), issuer_ift, issuer_ift, name("bob"), asset(1000000000000LL, IFT), std::string("")), "fund bob");
+    expect(c.push(token_ift, name("transfer"), issuer_ift, issuer_ift, name("carol"), asset(1000000000000LL, IFT), std::string("")), "fund carol");
+    expect(c.push(sift_ift, name("create"), sift_ift, staking_ift, asset(4000000000000000000LL, SIFT)), "create SIFT");
+    expect_fail(c.push(sift_ift, name("issueto"), name("alice"), name("alice"), asset(100000000LL, SIFT), std::string("")), "alice issueto");
+
+    expect(c.push(staking_ift, name("init"), admin_ift, uint64_t(1), uint64_t(28800), uint64_t(c.now().sec_since_epoch())), "init");
+    expect(c.push(staking_ift, name("addsymbol"), admin_ift, SIFT, sift_ift, uint64_t(3000), uint64_t(86400)), "addsymbol");
+
+    expect(c.push(staking_ift, name("updatelock"), admin_ift, SIFT.code(), uint64_t(86400), uint32_t(0)), "updatelock");
+    expect_fail(c.push(staking_ift, name("updatelock"), admin_ift, SIFT.code(), uint64_t(3600), uint32_t(86400)), "updatelock wider than the lock");
+    expect_fail(c.push(sift_ift, name("setlock"), staking_ift, SIFT.code(), uint64_t(3600), uint32_t(86400)), "setlock wider than the lock");
+    expect(c.push(token_ift, name("transfer"), name("alice"), name("alice"), staking_ift, asset(10000000000LL, IFT), std::string("SIFT")), "alice stake");
+    // an empty pool stakes one to one
+    expect_eq(balance(c, sift_ift, name("alice"), SIFT).amount, 10000000000LL, "alice SIFT");
+
+    c.advance(hours(9));
+    expect(c.push(token_ift, name("transfer"), name("bob"), name("bob"), staking_ift, asset(10000000000LL, IFT), std::string("SIFT")), "bob stake across epoch");
+    // one epoch at 0.3% of 1000000 IFT paid into the pool first, bob gets 100 SIFT per 3100 IFT
+    auto epoch = c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value);
+    expect_eq(epoch->distribute.amount, 300000000000LL, "distributed over one epoch");
+    expect_eq(balance(c, sift_ift, name("bob"), SIFT).amount, 322580645LL, "bob SIFT");
+    expect_pools(c, "pools after bob");
+
+    expect_fail(c.push(sift_ift, name("transfer"), name("alice"), name("alice"), staking_ift, asset(1000000000LL, SIFT), std::string("")), "alice early unstake");
+    expect_fail(c.push(staking_ift, name("unstakeburn"), name("alice"), name("alice"), asset(1000000000LL, SIFT)), "alice early burn unstake");
+    expect_fail(c.push(staking_ift, name("unstake"), name("alice"), name("alice"), asset(1000000000LL, SIFT), sift_ift, SIFT), "alice admin unstake");
+    expect_fail(c.push(sift_ift, name("burnfrom"), name("alice"), name("alice"), asset(1000000000LL, SIFT)), "alice burnfrom");
+    auto spendable = c.read(sift_ift, name("getspendable"), name("alice"), SIFT.code());
+    expect(spendable, "alice getspendable");
+    expect_eq(spendable.return_as<asset>().amount, 0, "alice spendable");
+    expect_fail(c.push(sift_ift, name("migratelocks"), name("alice"), name("alice"), SIFT.code(), name("alice")), "alice migratelocks after migration");
+    auto rate = c.read(staking_ift, name("getrate"), SIFT.code());
+    expect(rate, "getrate");
+    expect_eq(rate.return_as<asset>().amount, 3100000000LL, "IFT per SIFT");
+    auto next = c.read(staking_ift, name("nextepoch"));
+    expect(next, "nextepoch");
+    expect_eq(next.return_as<uint64_t>(), 25201, "next epoch in seconds");
+    c.advance(days(2));
+    auto alice_sift = balance(c, sift_ift, name("alice"), SIFT);
+    expect(c.push(staking_ift, name("unstakeburn"), name("alice"), name("alice"), asset(alice_sift.amount / 2, SIFT)), "alice burn unstake");
+    // six epochs ended, caught up in one distribution at 0.3% each on the supply after the first
+    epoch = c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value);
+    expect_eq(epoch->number, 8, "epoch after catch-up");
+    expect_eq(epoch->distribute.amount, 1818994784009LL, "distributed over six epochs");
+    alice_sift = balance(c, sift_ift, name("alice"), SIFT);
+    expect(c.push(sift_ift, name("transfer"), name("alice"), name("alice"), staking_ift, alice_sift, std::string("")), "alice unstake");
+    expect_eq(balance(c, token_ift, name("alice"), IFT).amount, 3062151197040LL, "alice IFT after unstaking");
+    expect_pools(c, "pools after alice unstakes");
+    expect(c.push(sift_ift, name("prunelocks"), name("bob"), std::vector<name>{ name("alice"), name("bob") }, SIFT.code(), uint32_t(10)), "prunelocks");
+    expect(c.push(sift_ift, name("close"), name("alice"), name("alice"), SIFT), "alice close");
+    struct stake_entry { name owner; asset quantity; symbol_code sc; };
+    expect(c.push(token_ift, name("transfer"), name("bob"), name("bob"), staking_ift, asset(50000000000LL, IFT), std::string("deposit")), "bob deposit");
+    std::vector<stake_entry> batch;
+    for (int i = 0; i < 4; i++) {
+        batch.push_back({ i % 2 ? name("alice") : name("bob"), asset(10000000000LL, IFT), symbol_code("SIFT") });
+    }
+    expect(c.push(staking_ift, name("stakebatch"), name("bob"), name("bob"), batch), "bob stakebatch");
+    expect_eq(balance(c, sift_ift, name("alice"), SIFT).amount, 96518053LL, "alice SIFT from the batch");
+    expect_eq(balance(c, sift_ift, name("bob"), SIFT).amount, 322580645LL + 96518053LL, "bob SIFT from the batch");
+    expect_pools(c, "pools after stakebatch");
+    expect(c.push(staking_ift, name("withdraw"), name("bob"), name("bob"), asset(10000000000LL, IFT)), "bob withdraw");
+    expect_fail(c.push(staking_ift, name("withdraw"), name("bob"), name("bob"), asset(1LL, IFT)), "bob overdraw");
+    std::vector<transfer_entry> payout { { name("alice"), 100000000LL, "a" }, { name("bob"), 200000000LL, "b" } };
+    expect(c.push(token_ift, name("transfers"), name("carol"), name("carol"), IFT, payout), "carol payout");
+    expect_eq(balance(c, token_ift, name("bob"), IFT).amount, 950200000000LL, "bob IFT");
+    payout.push_back({ name("carol"), 1, "" });
+    expect_fail(c.push(token_ift, name("transfers"), name("carol"), name("carol"), IFT, payout), "carol payout to self");
+
+    // one deposit split across two symbols by weight
+    static const symbol SIFTB("SIFTB", 8);
+    expect(c.push(sift_ift, name("create"), sift_ift, staking_ift, asset(4000000000000000000LL, SIFTB)), "create SIFTB");
+    expect(c.push(staking_ift, name("addsymbol"), admin_ift, SIFTB, sift_ift, uint64_t(1000), uint64_t(86400)), "addsymbol SIFTB");
+    auto split = c.push(token_ift, name("transfer"), name("carol"), name("carol"), staking_ift, asset(10000000000LL, IFT), std::string("SIFT:60,SIFTB:40"));
+    expect(split, "carol split stake");
+    // 60 IFT into SIFT at the pool's rate, 40 IFT into the empty SIFTB one to one
+    expect_eq(balance(c, sift_ift, name("carol"), SIFT).amount, 28955416LL, "carol SIFT from the split");
+    expect_eq(balance(c, sift_ift, name("carol"), SIFTB).amount, 4000000000LL, "carol SIFTB from the split");
+    expect_eq(split.stats.inline_actions, 2, "split issues");
+    expect_pools(c, "pools after the split");
+    expect_fail(c.push(token_ift, name("transfer"), name("carol"), name("carol"), staking_ift, asset(10000000000LL, IFT), std::string("SIFT:60,SIFT:40")), "carol split duplicate");
+    expect_fail(c.push(token_ift, name("transfer"), name("carol"), name("carol"), staking_ift, asset(10000000000LL, IFT), std::string("SIFT:60,SIFTB:")), "carol split no weight");
+
+    // more lock buckets than the cap, the extra stakes join the later buckets
+    int carol_failures = 0;
+    for (int i = 0; i < 24; i++) {
+        carol_failures += !c.push(token_ift, name("transfer"), name("carol"), name("carol"), staking_ift, asset(1000000000LL, IFT), std::string("SIFT")).succeeded;
+        c.advance(hours(1));
+    }
+    auto carol_locks = c.get_row<lockpack_row>(sift_ift, name("carol").value, name("lockpacks"), SIFT.code().raw());
+    expect_eq(carol_failures, 0, "carol failed stakes");
+    expect_eq(carol_locks ? carol_locks->buckets.size() : 0, 20, "carol lock buckets");
+
+    // a symbol whose stat row predates setlock takes the lock time from staking's symbols row on the first credit
+    c.set_code(sift_ift, clear_lock_time);
+    expect(c.push(sift_ift, name("clearlock"), sift_ift, SIFT.code()), "clear SIFT lock time");
+    c.set_code(sift_ift, stakedtoken_apply);
+    auto carol_spendable = c.read(sift_ift, name("getspendable"), name("carol"), SIFT.code()).return_as<asset>();
+    expect(c.push(token_ift, name("transfer"), name("carol"), name("carol"), staking_ift, asset(1000000000LL, IFT), std::string("SIFT")), "carol stake without a lock time");
+    expect_eq(c.read(sift_ift, name("getspendable"), name("carol"), SIFT.code()).return_as<asset>().amount, carol_spendable.amount, "carol spendable after the stake");
+    std::vector<transfer_entry> sift_payout { { name("bob"), 1000000LL, "" } };
+    expect(c.push(sift_ift, name("transfers"), name("carol"), name("carol"), SIFT, sift_payout), "carol SIFT payout");
+    sift_payout.push_back({ staking_ift, 1000000LL, "" });
+    expect_fail(c.push(sift_ift, name("transfers"), name("carol"), name("carol"), SIFT, sift_payout), "carol SIFT payout to staking");
+    auto sift_stat = c.get_row<stat_row>(sift_ift, SIFT.code().raw(), name("stat"), SIFT.code().raw());
+    expect_eq(sift_stat->lock_time.value_or(0), 86400, "SIFT lock time kept in stat");
+    expect_eq(sift_stat->lock_granularity.value_or(0), 3600, "SIFT lock granularity kept in stat");
+
+    // a holder whose locks were never migrated burns through staking, which cannot bill them for a lock pack
+    c.create_account(name("dave"));
+    expect(c.push(token_ift, name("transfer"), issuer_ift, issuer_ift, name("dave"), asset(10000000000LL, IFT), std::string("")), "fund dave");
+    expect(c.push(token_ift, name("transfer"), name("dave"), name("dave"), staking_ift, asset(10000000000LL, IFT), std::string("SIFT")), "dave stake");
+    c.advance(days(2));
+    expect(c.push(sift_ift, name("prunelocks"), name("dave"), std::vector<name>{ name("dave") }, SIFT.code(), uint32_t(10)), "dave prunelocks");
+    auto dave_sift = balance(c, sift_ift, name("dave"), SIFT);
+    auto legacy_release = block_timestamp(c.now() + days(1));
+    c.set_code(sift_ift, seed_legacy_lock);
+    expect(c.push(sift_ift, name("seedlock"), staking_ift, name("dave"), staking_ift, std::make_tuple(uint64_t(1), legacy_release, SIFT.code(), uint64_t(dave_sift.amount / 2))), "dave legacy lock");
+    c.set_code(sift_ift, stakedtoken_apply);
+    expect_fail(c.push(staking_ift, name("unstakeburn"), name("dave"), name("dave"), dave_sift), "dave burn unstake of a legacy lock");
+    auto dave_burn = c.push(staking_ift, name("unstakeburn"), name("dave"), name("dave"), asset(dave_sift.amount / 2, SIFT));
+    expect(dave_burn, "dave burn unstake beside a legacy lock");
+    expect_eq(dave_burn.ram_delta.count(name("dave")) ? dave_burn.ram_delta.at(name("dave")) : 0, 0, "dave ram billed by burn");
+    auto dave_locks = c.find_table(sift_ift, name("dave").value, name("locks"));
+    expect_eq(dave_locks ? dave_locks->rows.size() : 0, 1, "dave legacy locks kept");
+}
+
+// more symbols than one distribute page, a stake into a symbol the pages have not reached pays its share first
+static void paged_distribution() {
+    chain c;
+    for (auto n : { issuer_ift, admin_ift, name("alice"), name("bob") }) {
+        c.create_account(n);
+    }
+    c.set_code(token_ift, ifttoken_apply);
+    c.set_code(sift_ift, stakedtoken_apply);
+    c.set_code(staking_ift, staking_apply);
+    c.grant_code(issuer_ift, staking_ift);
+
+    expect(c.push(token_ift, name("create"), token_ift, issuer_ift, asset(10000000000000000LL, IFT)), "create IFT");
+    expect(c.push(token_ift, name("issue"), issuer_ift, issuer_ift, asset(100000000000000LL, IFT), std::string("init")), "issue IFT");
+    expect(c.push(token_ift, name("transfer"), issuer_ift, issuer_ift, name("alice"), asset(1000000000000LL, IFT), std::string("")), "fund alice");
+    expect(c.push(token_ift, name("transfer"), issuer_ift, issuer_ift, name("bob"), asset(1000000000000LL, IFT), std::string("")), "fund bob");
+    expect(c.push(staking_ift, name("init"), admin_ift, uint64_t(1), uint64_t(28800), uint64_t(c.now().sec_since_epoch())), "init");
+
+    // SA to SL, ordered by raw code so SK and SL fall on the second page
+    const int symbol_count = 12;
+    std::vector<symbol> syms;
+    for (int i = 0; i < symbol_count; i++) {
+        syms.emplace_back(symbol_code(std::string("S") + char('A' + i)), 8);
+        expect(c.push(sift_ift, name("create"), sift_ift, staking_ift, asset(4000000000000000000LL, syms.back())), "create staked symbol");
+        expect(c.push(staking_ift, name("addsymbol"), admin_ift, syms.back(), sift_ift, uint64_t(1000), uint64_t(86400)), "addsymbol");
+    }
+    const symbol SL = syms.back();
+
+    expect(c.push(token_ift, name("transfer"), name("alice"), name("alice"), staking_ift, asset(10000000000LL, IFT), std::string("SL")), "alice stake SL");
+    expect_eq(balance(c, sift_ift, name("alice"), SL).amount, 10000000000LL, "alice SL");
+
+    // one epoch grows the supply by the summed rate, 1.2%, and each symbol takes a twelfth
+    const int64_t growth = 1200000000000LL, share = growth / symbol_count;
+    c.advance(hours(9));
+    expect(c.push(token_ift, name("transfer"), name("bob"), name("bob"), staking_ift, asset(10000000000LL, IFT), std::string("SL")), "bob stake SL during distribution");
+    auto sl = c.get_row<symbol_row>(staking_ift, staking_ift.value, name("symbols"), SL.code().raw());
+    expect_eq(sl->locked.amount, 10000000000LL + share + 10000000000LL, "SL locked after bob");
+    // 100 IFT at 1100 IFT per 100 SL, rounded down
+    expect_eq(balance(c, sift_ift, name("bob"), SL).amount, 909090909LL, "bob SL");
+    expect_eq(c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value)->distribute.amount, share * 11, "distributed after bob");
+
+    // the issuer retires most of the supply between pages, the last page is minted in steps of the live supply
+    const int64_t retired = 92000000000000LL;
+    expect(c.push(token_ift, name("retire"), issuer_ift, asset(retired, IFT), std::string("")), "retire IFT between pages");
+    auto second_page = c.push(staking_ift, name("distribute"), admin_ift);
+    expect(second_page, "distribute second page");
+    expect_eq(second_page.stats.inline_actions, 2, "issue steps of the second page");
+    auto epoch = c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value);
+    expect_eq(epoch->cursor.value_or(0), 0, "distribution done");
+    expect_eq(epoch->distribute.amount, growth, "distributed in the epoch");
+    sl = c.get_row<symbol_row>(staking_ift, staking_ift.value, name("symbols"), SL.code().raw());
+    expect_eq(sl->locked.amount, 10000000000LL + share + 10000000000LL, "SL paid once");
+    expect_eq(balance(c, token_ift, staking_ift, IFT).amount, growth + 20000000000LL, "staking.ift IFT");
+    auto ift_stat = c.get_row<stat_row>(token_ift, IFT.code().raw(), name("stat"), IFT.code().raw());
+    expect_eq(ift_stat->supply.amount, 100000000000000LL + growth - retired, "IFT supply");
+    expect_pools(c, "pools after the paged distribution");
+}
+
+// a halt longer than MAX_CATCHUP_EPOCHS is caught up over several distributions
+static void long_halt() {
+    chain c;
+    for (auto n : { issuer_ift, admin_ift }) {
+        c.create_account(n);
+    }
+    c.set_code(token_ift, ifttoken_apply);
+    c.set_code(sift_ift, stakedtoken_apply);
+    c.set_code(staking_ift, staking_apply);
+    c.grant_code(issuer_ift, staking_ift);
+
+    expect(c.push(token_ift, name("create"), token_ift, issuer_ift, asset(10000000000000000LL, IFT)), "create IFT");
+    expect(c.push(token_ift, name("issue"), issuer_ift, issuer_ift, asset(100000000000000LL, IFT), std::string("init")), "issue IFT");
+    expect(c.push(sift_ift, name("create"), sift_ift, staking_ift, asset(4000000000000000000LL, SIFT)), "create SIFT");
+    expect(c.push(staking_ift, name("init"), admin_ift, uint64_t(1), uint64_t(28800), uint64_t(c.now().sec_since_epoch())), "init");
+    expect(c.push(staking_ift, name("addsymbol"), admin_ift, SIFT, sift_ift, uint64_t(10), uint64_t(86400)), "addsymbol");
+
+    c.advance(seconds(1500 * 28800 + 1));
+    expect(c.push(staking_ift, name("distribute"), admin_ift), "distribute first 1000 epochs");
+    auto epoch = c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value);
+    expect_eq(epoch->number, 1001, "epoch after first catch-up");
+    expect_eq(epoch->distribute.amount, 1005011657703LL, "distributed over 1000 epochs");
+    expect_eq(c.read(staking_ift, name("nextepoch")).return_as<uint64_t>(), 0, "next epoch due");
+
+    expect(c.push(staking_ift, name("distribute"), admin_ift), "distribute last 500 epochs");
+    epoch = c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value);
+    expect_eq(epoch->number, 1501, "epoch after second catch-up");
+    expect_eq(epoch->distribute.amount, 506287189805LL, "distributed over 500 epochs");
+    expect_eq(c.read(staking_ift, name("nextepoch")).return_as<uint64_t>(), 28800, "next epoch after catch-up");
+    auto ift_stat = c.get_row<stat_row>(token_ift, IFT.code().raw(), name("stat"), IFT.code().raw());
+    expect_eq(ift_stat->supply.amount, 100000000000000LL + 1005011657703LL + 506287189805LL, "IFT supply");
+
+    // 10% a epoch for two epochs is more than MAX_ISSUE_STEPS issues of 1%, the rest is minted by the calls after
+    expect(c.push(staking_ift, name("updaterate"), admin_ift, SIFT.code(), uint64_t(100000)), "updaterate");
+    c.advance(seconds(2 * 28800));
+    auto fast = c.push(staking_ift, name("distribute"), admin_ift);
+    expect(fast, "distribute 21%");
+    expect_eq(fast.stats.inline_actions, 10, "issue steps of one call");
+    epoch = c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value);
+    const int64_t fast_growth = 21317372757975LL;
+    expect_eq(epoch->distribute.amount, fast_growth, "distributed over two epochs at 10%");
+    expect_eq(c.read(staking_ift, name("nextepoch")).return_as<uint64_t>(), 0, "next epoch while minting");
+    int calls = 0;
+    do {
+        expect(c.push(staking_ift, name("distribute"), admin_ift), "distribute the rest");
+        epoch = c.get_row<epoch_row>(staking_ift, staking_ift.value, name("epoch"), name("epoch").value);
+        calls++;
+    } while (epoch->unminted.value_or(0) > 0 && calls < 10);
+    expect_eq(calls, 1, "calls minting the rest");
+    ift_stat = c.get_row<stat_row>(token_ift, IFT.code().raw(), name("stat"), IFT.code().raw());
+    expect_eq(ift_stat->supply.amount, 100000000000000LL + 1005011657703LL + 506287189805LL + fast_growth, "IFT supply after minting");
+    expect_eq(balance(c, token_ift, staking_ift, IFT).amount, 1005011657703LL + 506287189805LL + fast_growth, "staking.ift IFT");
+}
+
+int main() {
+    stake_and_unstake();
+    paged_distribution();
+    long_halt();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,367 @@
+#include <stakemath.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Monte Carlo model of the staking economics on the contract's own arithmetic
+ * (stakemath.hpp): every epoch the IFT supply compounds by the summed rate, each
+ * symbol takes its share into its pool and refreshes its cached indexes, then random
+ * stakers stake and unstake at the cached indexes like _apply_stake and
+ * _apply_unstake do. Each `--symbol` may list several rates; every combination is
+ * run `--runs` times with different seeds, the jobs spread over `--threads`.
+ * Results go to stdout as one JSON document.
+ */
+
+using fixedmath::u128;
+
+struct symbol_params {
+    std::string name;
+    std::vector<uint64_t> rates;
+};
+
+struct options {
+    uint64_t epochs = 100000;
+    uint64_t stakers = 1000;
+    uint64_t runs = 8;
+    uint64_t activity = 10;
+    uint64_t supply = 100000000;
+    uint64_t wallet = 1000;
+    uint64_t epoch_length = 28800;
+    uint64_t seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<symbol_params> symbols;
+};
+
+// the smallest stake _apply_stake accepts is above this
+static const uint64_t min_stake = 10000000;
+static const uint64_t precision = 100000000;
+
+struct pool {
+    uint64_t rate = 0;
+    uint64_t locked = 0;
+    uint64_t issued = 0;
+    u128 stake_index = fixedmath::one;
+    u128 unstake_index = fixedmath::one;
+
+    void refresh() {
+        stake_index = stakemath::stake_index(locked, issued);
+        unstake_index = stakemath::unstake_index(locked, issued);
+    }
+};
+
+struct staker {
+    uint64_t wallet;
+    uint64_t held;
+    size_t sym;
+};
+
+// per symbol outcome of one run. Rounding sums the exact amount at the pool's current ratio less
+// what the cached index paid, in raw units, so a stale index shows up as well as the floor;
+// positive is kept by the pool
+struct symbol_result {
+    double locked_per_issued = 0;
+    double max_drift = 0;
+    double stake_rounding = 0;
+    double unstake_rounding = 0;
+    double distribute_rounding = 0;
+    double residual = 0;
+    double underflows = 0;
+};
+
+struct run_result {
+    double supply_growth = 0;
+    double annual_growth = 0;
+    // the first epoch the supply reached the asset maximum, -1 when it never did
+    double saturated_epoch = -1;
+    std::vector<symbol_result> symbols;
+};
+
+static double ratio(uint64_t a, uint64_t b) {
+    return b == 0 ? 1.0 : double(a) / double(b);
+}
+
+static double index_value(u128 index) {
+    return double(index) / double(fixedmath::one);
+}
+
+static run_result run(const options& opt, const std::vector<uint64_t>& rates, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<pool> pools(rates.size());
+    uint64_t total_rate = 0;
+    for (size_t i = 0; i < rates.size(); i++) {
+        pools[i].rate = rates[i];
+        total_rate += rates[i];
+    }
+    run_result result;
+    result.symbols.resize(rates.size());
+
+    uint64_t supply = opt.supply * precision;
+    const uint64_t initial_supply = supply;
+    std::vector<staker> stakers(opt.stakers);
+    for (size_t i = 0; i < stakers.size(); i++) {
+        stakers[i] = { opt.wallet * precision, 0, i % pools.size() };
+    }
+
+    auto stake = [&](staker& s, uint64_t quantity) {
+        auto& p = pools[s.sym];
+        auto& r = result.symbols[s.sym];
+        uint64_t new_issue = stakemath::convert(quantity, p.stake_index);
+        double exact = p.issued == 0 || p.locked == 0 ? double(quantity) : quantity * ratio(p.issued, p.locked);
+        r.stake_rounding += exact - double(new_issue);
+        bool empty = p.issued == 0;
+        p.locked += quantity;
+        p.issued += new_issue;
+        if (empty) {
+            p.refresh();
+        }
+        s.wallet -= quantity;
+        s.held += new_issue;
+    };
+
+    auto unstake = [&](staker& s, uint64_t quantity) {
+        auto& p = pools[s.sym];
+        auto& r = result.symbols[s.sym];
+        uint64_t release = stakemath::convert(quantity, p.unstake_index);
+        if (release > p.locked) {
+            // the contract would drive locked negative here
+            r.underflows++;
+            return;
+        }
+        r.unstake_rounding += quantity * ratio(p.locked, p.issued) - double(release);
+        p.locked -= release;
+        p.issued -= quantity;
+        if (p.issued == 0) {
+            p.refresh();
+        }
+        s.wallet += release;
+        s.held -= quantity;
+    };
+
+    // every staker starts with half the wallet in its symbol
+    for (auto& s : stakers) {
+        stake(s, s.wallet / 2);
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, stakers.size() - 1);
+    for (uint64_t epoch = 0; epoch < opt.epochs; epoch++) {
+        uint64_t growth = stakemath::compound(supply, total_rate, 1) - supply;
+        uint64_t minted = 0;
+        for (size_t i = 0; i < pools.size(); i++) {
+            auto& p = pools[i];
+            if (p.rate == 0) {
+                continue;
+            }
+            uint64_t distribute = stakemath::share(growth, p.rate, total_rate);
+            result.symbols[i].distribute_rounding += double(growth) * p.rate / total_rate - double(distribute);
+            if (distribute > 0) {
+                p.locked += distribute;
+                p.refresh();
+            }
+            minted += distribute;
+        }
+        supply += minted;
+        if (supply >= stakemath::MAX_AMOUNT && result.saturated_epoch < 0) {
+            result.saturated_epoch = epoch;
+        }
+
+        for (uint64_t a = 0; a < opt.activity; a++) {
+            auto& s = stakers[pick(rng)];
+            if (s.held > 0 && (s.wallet <= min_stake || rng() & 1)) {
+                unstake(s, std::uniform_int_distribution<uint64_t>(1, s.held)(rng));
+            } else if (s.wallet > min_stake) {
+                stake(s, std::uniform_int_distribution<uint64_t>(min_stake + 1, s.wallet)(rng));
+            }
+        }
+
+        // how far the cached unstake index is from the pool's exact ratio
+        for (size_t i = 0; i < pools.size(); i++) {
+            auto& p = pools[i];
+            if (p.issued > 0) {
+                double exact = ratio(p.locked, p.issued);
+                result.symbols[i].max_drift = std::max(result.symbols[i].max_drift, std::abs(index_value(p.unstake_index) - exact) / exact);
+            }
+        }
+    }
+
+    result.supply_growth = double(supply) / double(initial_supply);
+    double years = double(opt.epochs) * opt.epoch_length / (365.0 * 86400);
+    result.annual_growth = std::pow(result.supply_growth, 1 / years) - 1;
+    for (size_t i = 0; i < pools.size(); i++) {
+        auto& p = pools[i];
+        auto& r = result.symbols[i];
+        r.locked_per_issued = ratio(p.locked, p.issued);
+        // IFT that redeeming every issued token at a fresh index would leave behind
+        r.residual = double(p.locked - stakemath::convert(p.issued, stakemath::unstake_index(p.locked, p.issued)));
+    }
+    return result;
+}
+
+struct summary {
+    double sum = 0;
+    double min = INFINITY;
+    double max = -INFINITY;
+    uint64_t n = 0;
+
+    void add(double v) {
+        sum += v;
+        min = std::min(min, v);
+        max = std::max(max, v);
+        n++;
+    }
+};
+
+static void print_summary(const char* key, const summary& s, bool last = false) {
+    std::printf("\"%s\": {\"mean\": %.10g, \"min\": %.10g, \"max\": %.10g}%s", key, s.n ? s.sum / s.n : 0, s.n ? s.min : 0, s.n ? s.max : 0, last ? "" : ", ");
+}
+
+static bool parse_symbol(const char* arg, symbol_params& out) {
+    // NAME:RATE[,RATE...]
+    const char* colon = std::strchr(arg, ':');
+    if (!colon || colon == arg) {
+        return false;
+    }
+    out.name.assign(arg, colon);
+    for (const char* p = colon + 1; *p;) {
+        char* end;
+        out.rates.push_back(std::strtoull(p, &end, 10));
+        if (end == p) {
+            return false;
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+    return !out.rates.empty();
+}
+
+int main(int argc, char** argv) {
+    options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        uint64_t value = std::strtoull(argv[i + 1], nullptr, 10);
+        if (!std::strcmp(argv[i], "--symbol")) {
+            symbol_params s;
+            if (!parse_symbol(argv[i + 1], s)) {
+                std::fprintf(stderr, "bad --symbol %s, expected NAME:RATE[,RATE...]\n", argv[i + 1]);
+                return 2;
+            }
+            opt.symbols.push_back(s);
+        } else if (!std::strcmp(argv[i], "--epochs")) {
+            opt.epochs = value;
+        } else if (!std::strcmp(argv[i], "--stakers")) {
+            opt.stakers = value;
+        } else if (!std::strcmp(argv[i], "--runs")) {
+            opt.runs = value;
+        } else if (!std::strcmp(argv[i], "--activity")) {
+            opt.activity = value;
+        } else if (!std::strcmp(argv[i], "--supply")) {
+            opt.supply = value;
+        } else if (!std::strcmp(argv[i], "--wallet")) {
+            opt.wallet = value;
+        } else if (!std::strcmp(argv[i], "--epoch-length")) {
+            opt.epoch_length = value;
+        } else if (!std::strcmp(argv[i], "--seed")) {
+            opt.seed = value;
+        } else if (!std::strcmp(argv[i], "--threads")) {
+            opt.threads = std::max<uint64_t>(value, 1);
+        } else {
+            std::fprintf(stderr, "usage: %s [--symbol NAME:RATE[,RATE...]]... [--epochs N] [--stakers N] [--runs N] [--activity N] "
+                "[--supply IFT] [--wallet IFT] [--epoch-length SECONDS] [--seed N] [--threads N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (opt.symbols.empty()) {
+        opt.symbols.push_back({ "SIFT", { 3000 } });
+    }
+    if (opt.stakers < 1 || opt.runs < 1 || opt.epoch_length < 1 || opt.supply * precision / precision != opt.supply
+        || opt.supply * precision > stakemath::MAX_AMOUNT || opt.wallet * precision * opt.stakers > stakemath::MAX_AMOUNT) {
+        std::fprintf(stderr, "need at least 1 staker, run and second per epoch, and supply and wallets within the asset maximum\n");
+        return 2;
+    }
+
+    // every combination of one rate per symbol, the first symbol varies fastest
+    std::vector<std::vector<uint64_t>> combinations(1);
+    for (const auto& s : opt.symbols) {
+        std::vector<std::vector<uint64_t>> next;
+        for (auto rate : s.rates) {
+            for (auto combination : combinations) {
+                combination.push_back(rate);
+                next.push_back(combination);
+            }
+        }
+        combinations = std::move(next);
+    }
+    for (const auto& c : combinations) {
+        uint64_t total = 0;
+        for (auto rate : c) {
+            total += rate;
+        }
+        if (total == 0) {
+            std::fprintf(stderr, "every combination needs a positive total rate\n");
+            return 2;
+        }
+    }
+
+    size_t jobs = combinations.size() * opt.runs;
+    std::vector<run_result> results(jobs);
+    std::atomic<size_t> next_job { 0 };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < std::min<size_t>(opt.threads, jobs); t++) {
+        workers.emplace_back([&] {
+            for (size_t job = next_job++; job < jobs; job = next_job++) {
+                // distinct, reproducible streams per run
+                std::seed_seq seq { opt.seed, uint64_t(job) };
+                std::array<uint32_t, 2> words;
+                seq.generate(words.begin(), words.end());
+                results[job] = run(opt, combinations[job / opt.runs], uint64_t(words[0]) << 32 | words[1]);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    std::printf("{\n  \"config\": {\"epochs\": %llu, \"stakers\": %llu, \"runs\": %llu, \"activity\": %llu, \"supply\": %llu, \"wallet\": %llu, \"epoch_length\": %llu, \"seed\": %llu},\n  \"results\": [\n",
+        (unsigned long long)opt.epochs, (unsigned long long)opt.stakers, (unsigned long long)opt.runs, (unsigned long long)opt.activity,
+        (unsigned long long)opt.supply, (unsigned long long)opt.wallet, (unsigned long long)opt.epoch_length, (unsigned long long)opt.seed);
+    for (size_t c = 0; c < combinations.size(); c++) {
+        summary growth, annual, saturated;
+        std::vector<std::array<summary, 7>> symbols(opt.symbols.size());
+        for (size_t r = 0; r < opt.runs; r++) {
+            const auto& res = results[c * opt.runs + r];
+            growth.add(res.supply_growth);
+            annual.add(res.annual_growth);
+            saturated.add(res.saturated_epoch);
+            for (size_t i = 0; i < symbols.size(); i++) {
+                const auto& s = res.symbols[i];
+                double values[7] = { s.locked_per_issued, s.max_drift, s.stake_rounding, s.unstake_rounding, s.distribute_rounding, s.residual, s.underflows };
+                for (size_t k = 0; k < 7; k++) {
+                    symbols[i][k].add(values[k]);
+                }
+            }
+        }
+        std::printf("    {");
+        print_summary("supply_growth", growth);
+        print_summary("annual_growth", annual);
+        print_summary("saturated_epoch", saturated);
+        std::printf("\"symbols\": [");
+        for (size_t i = 0; i < symbols.size(); i++) {
+            static const char* keys[7] = { "locked_per_issued", "max_drift", "stake_rounding", "unstake_rounding", "distribute_rounding", "residual", "underflows" };
+            std::printf("%s\n      {\"symbol\": \"%s\", \"rate\": %llu, ", i ? "," : "", opt.symbols[i].name.c_str(), (unsigned long long)combinations[c][i]);
+            for (size_t k = 0; k < 7; k++) {
+                print_summary(keys[k], symbols[i][k], k == 6);
+            }
+            std::printf("}");
+        }
+        std::printf("]}%s\n", c + 1 == combinations.size() ? "" : ",");
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
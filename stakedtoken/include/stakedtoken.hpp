@@ -1,23 +1,34 @@
 #pragma once
 
 #include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/system.hpp>
 
+#include <actiondata.hpp>
+#include <tokencore.hpp>
+
+#include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace eosio;
 using std::string;
 
+struct transfer_entry {
+    name     to;
+    int64_t  amount;
+    string   memo;
+};
+
+// the head of staking's symbols row, read once for a symbol whose stat row has no lock time yet
 namespace stakingtable {
     struct st_symbol {
         symbol sym;
         name sname;
         uint64_t rate;
         uint64_t lock_time;
-        asset distribute;
-        asset locked;
-        asset issued;
         uint64_t primary_key() const { return sym.code().raw(); }
     };
     typedef multi_index<"symbols"_n, st_symbol> symbols_mi;
@@ -29,6 +40,7 @@ class [[eosio::contract("stakedtoken")]] token : public contract {
         using contract::contract;
 
         static constexpr name STAKING_ACCOUNT { name("staking.ift") };
+        static constexpr size_t MAX_LOCK_BUCKETS = 20;
 
         /**
          * Allows `issuer` account to create a token in supply of `maximum_supply`. If validation is successful a new entry in statstable for token symbol scope gets created.
@@ -52,6 +64,17 @@ class [[eosio::contract("stakedtoken")]] token : public contract {
          */
         [[eosio::action]]
         void issue(const name& to, const asset& quantity, const string& memo);
+        /**
+         * Issues `quantity` straight into `to`'s balance, the same as `issue` followed by a
+         * transfer from the issuer, in one action.
+         * In stakedtoken the amount is locked for `to` like a transfer from the issuer.
+         *
+         * @param to - the account to issue tokens to,
+         * @param quantity - the amount of tokens to be issued,
+         * @param memo - the memo string that accompanies the token issue transaction.
+         */
+        [[eosio::action]]
+        void issueto(const name& to, const asset& quantity, const string& memo);
 
         /**
          * The opposite for create action, if all validations succeed,
@@ -63,6 +86,19 @@ class [[eosio::contract("stakedtoken")]] token : public contract {
         [[eosio::action]]
         void retire(const asset& quantity, const string& memo);
 
+        /**
+         * Burns `quantity` from `owner`'s balance and the supply in one action, so unstaking
+         * needs no transfer to the staking contract and retire from there. Locked tokens
+         * cannot be burned, the same as they cannot be transferred.
+         *
+         * @param owner - the account whose tokens are burned,
+         * @param quantity - the quantity of tokens to burn.
+         *
+         * @pre Only `STAKING_ACCOUNT` can burn, after it checked `owner`'s authority.
+         */
+        [[eosio::action]]
+        void burnfrom(const name& owner, const asset& quantity);
+
         /**
          * Allows `from` account to transfer to `to` account the `quantity` tokens.
          * One account is debited and the other is credited with quantity tokens.
@@ -74,6 +110,19 @@ class [[eosio::contract("stakedtoken")]] token : public contract {
          */
         [[eosio::action]]
         void transfer(const name&    from,  const name&    to, const asset&   quantity, const string&  memo);
+
+        /**
+         * Allows `from` account to transfer `sym` tokens to every recipient of `transfers` in one action.
+         * The symbol is checked and `from` is debited once for the total, with one lock check.
+         * Recipients are notified of `transfers`, not `transfer`, so contracts that act on incoming
+         * transfers must still be sent a `transfer`. The staking contract cannot be a recipient.
+         *
+         * @param from - the account to transfer from,
+         * @param sym - the symbol of the tokens to be transferred,
+         * @param transfers - the recipients, each with its amount and memo.
+         */
+        [[eosio::action]]
+        void transfers(const name& from, const symbol& sym, const std::vector<transfer_entry>& transfers);
         /**
          * Allows `ram_payer` to create an account `owner` with zero balance for
          * token `symbol` at the expense of `ram_payer`.
@@ -97,10 +146,70 @@ class [[eosio::contract("stakedtoken")]] token : public contract {
          *
          * @pre The pair of owner plus symbol has to exist otherwise no action is executed,
          * @pre If the pair of owner plus symbol exists, the balance has to be zero.
+         *
+         * The owner's lock rows for `symbol` are erased with the balance.
          */
         [[eosio::action]]
         void close(const name& owner, const symbol& symbol );
 
+        /**
+         * Returns the part of `owner`'s balance that `transfer` lets through, the balance less
+         * every lock that has not been released yet. Read only, expired locks are skipped, not erased.
+         *
+         * @param owner - the account to query,
+         * @param sym - the symbol code of the token to query.
+         */
+        [[eosio::action, eosio::read_only]]
+        asset getspendable(const name& owner, const symbol_code& sym);
+
+        /**
+         * Erases expired `sym` locks of `owners`, so holders that never transfer again do not
+         * keep paying for them. Anyone can call it; it stops after `max_rows` lock rows have been
+         * rewritten or erased. Owners are passed in because a contract cannot list table scopes.
+         *
+         * @param owners - the accounts whose locks are pruned,
+         * @param sym - the symbol code of the locks,
+         * @param max_rows - the most lock rows to rewrite or erase.
+         */
+        [[eosio::action]]
+        void prunelocks(const std::vector<name>& owners, const symbol_code& sym, uint32_t max_rows);
+
+        /**
+         * Sets how long received `sym` tokens stay locked and the width of the lock buckets release
+         * times are rounded down to. A holder keeps at most `MAX_LOCK_BUCKETS` buckets, once full a
+         * new amount joins the nearest later bucket.
+         *
+         * @param sym - the symbol code of the token,
+         * @param lock_time - seconds a received amount stays locked,
+         * @param granularity - the bucket width in seconds, 0 picks minute, hour, day or week
+         * as `lock_time` reaches a day, 30 days and 90 days.
+         *
+         * @pre Only the token issuer can set the lock time.
+         * @pre `granularity` is not longer than `lock_time`.
+         */
+        [[eosio::action]]
+        void setlock(const symbol_code& sym, uint64_t lock_time, uint32_t granularity);
+
+        /**
+         * Moves `owner`'s `sym` rows of the old one row per bucket `locks` table into a single
+         * `lockpacks` row. Transfers migrate on first touch, this lets the remaining holders be
+         * migrated ahead of time.
+         *
+         * @param owner - the account whose locks are migrated,
+         * @param sym - the symbol code of the locks,
+         * @param ram_payer - the account that pays for the new row.
+         *
+         * @pre `owner` has `sym` rows in `locks` and no `lockpacks` row for `sym`.
+         */
+        [[eosio::action]]
+        void migratelocks(const name& owner, const symbol_code& sym, const name& ram_payer);
+
+        // the bucket width setlock picks for granularity 0
+        static uint32_t lock_granularity(uint64_t lock_time);
+
+        // the contract's apply, transfer, issue, issueto and retire are decoded in place with the memo as a view
+        static void dispatch(uint64_t receiver, uint64_t code, uint64_t action);
+
         static asset get_supply(const name& token_contract_account, const symbol_code& sym_code) {
             stats statstable( token_contract_account, sym_code.raw() );
             const auto& st = statstable.get( sym_code.raw() );
@@ -113,7 +222,7 @@ class [[eosio::contract("stakedtoken")]] token : public contract {
             return ac.balance;
         }
 
-    private:
+        // the rows are public so native tools can decode table dumps with these structs
         struct [[eosio::table]] account {
             asset    balance;
             uint64_t primary_key()const { return balance.symbol.code().raw(); }
@@ -123,6 +232,9 @@ class [[eosio::contract("stakedtoken")]] token : public contract {
             asset    supply;
             asset    max_supply;
             name     issuer;
+            // set by setlock, the lock duration and the bucket width release times are rounded to
+            binary_extension<uint64_t> lock_time;
+            binary_extension<uint32_t> lock_granularity;
 
             uint64_t primary_key()const { return supply.symbol.code().raw(); }
         };
@@ -135,15 +247,55 @@ class [[eosio::contract("stakedtoken")]] token : public contract {
             uint64_t get_sym() const { return sym.raw(); }
             uint64_t primary_key() const { return lock_id; }
         };
-        
+
+        struct lock_bucket {
+            block_timestamp release_time;
+            uint64_t amount;
+        };
+
+        // all locks of one holder and symbol in one row, buckets sorted by release_time,
+        // earliest is the first release_time so a transfer before it needs no pruning
+        struct [[eosio::table]] st_lockpack {
+            symbol_code sym;
+            uint64_t locked_total;
+            block_timestamp earliest;
+            std::vector<lock_bucket> buckets;
+            uint64_t primary_key() const { return sym.raw(); }
+        };
 
         typedef eosio::multi_index< "accounts"_n, account > accounts;
         typedef eosio::multi_index< "stat"_n, currency_stats > stats;
         typedef eosio::multi_index<"locks"_n, st_lock, indexed_by<"bysym"_n, const_mem_fun<st_lock, uint64_t, &st_lock::get_sym>>> locks_mi;
+        typedef eosio::multi_index<"lockpacks"_n, st_lockpack> lockpacks_mi;
+
+    private:
+        // the token core's lock policy, received amounts are locked in `lockpacks`
+        struct time_lock {
+            static constexpr bool enabled = true;
+            token* contract = nullptr;
+
+            bool can_spend(const name& owner, const asset& balance) { return contract->check_lock(owner, balance); }
+            void on_receive(const name& owner, const asset& quantity, const name& ram_payer, const currency_stats& st) {
+                contract->add_lock(owner, quantity, ram_payer, st);
+            }
+            void on_close(const name& owner, const symbol_code& sym) { contract->erase_locks(owner, sym); }
+            // staking only unstakes on a `transfer` notification, batched tokens would be stuck there
+            bool accepts_batch(const name& to) { return to != STAKING_ACCOUNT; }
+        };
+
+        // issue is only bounded by max_supply
+        typedef tokencore::basic_token<accounts, stats, tokencore::no_issue_cap, time_lock> token_core;
+
+        token_core core() { return token_core(get_self(), time_lock{ this }); }
 
-        void sub_balance(const name& owner, const asset& value, bool is_check);
-        void add_balance(const name& owner, const asset& value, const name& ram_payer, bool add_lock);
+        void add_lock(const name& owner, const asset& value, const name& ram_payer, const currency_stats& st);
+        std::pair<uint64_t, uint32_t> lock_config(const currency_stats& st);
 
         bool check_lock(const name& owner, const asset& balance);
+        int64_t locked_amount(const name& owner, const symbol_code& sym);
+        lockpacks_mi::const_iterator migrate_locks(lockpacks_mi& packs, const name& owner, const symbol_code& sym, const name& ram_payer);
+        static std::vector<lock_bucket>::const_iterator first_live(const std::vector<lock_bucket>& buckets, const block_timestamp& now_time);
+        static void drop_expired(st_lockpack& pack, const block_timestamp& now_time);
+        void erase_locks(const name& owner, const symbol_code& sym);
 
 };
@@ -1,227 +1,369 @@
 #include <stakedtoken.hpp>
 
 void token::create(const name&   issuer, const asset&  maximum_supply) {
-    require_auth(get_self());
+    core().create(issuer, maximum_supply);
+}
 
-    auto sym = maximum_supply.symbol;
-    check(sym.is_valid(), "invalid symbol name");
-    check(maximum_supply.is_valid(), "invalid supply");
-    check(maximum_supply.amount > 0, "max-supply must be positive");
+void token::issue(const name& to, const asset& quantity, const string& memo) {
+    core().issue(to, quantity, memo);
+}
 
-    stats statstable(get_self(), sym.code().raw());
-    auto existing = statstable.find(sym.code().raw());
-    check(existing == statstable.end(), "token with symbol already exists");
+void token::issueto(const name& to, const asset& quantity, const string& memo) {
+    core().issueto(to, quantity, memo);
+}
 
-    statstable.emplace(get_self(), [&](auto& s) {
-        s.supply.symbol = maximum_supply.symbol;
-        s.max_supply    = maximum_supply;
-        s.issuer        = issuer;
-    });
+void token::retire(const asset& quantity, const string& memo) {
+    core().retire(quantity, memo);
 }
 
+void token::burnfrom(const name& owner, const asset& quantity) {
+    require_auth(STAKING_ACCOUNT);
+    core().burnfrom(owner, quantity);
+}
 
-void token::issue(const name& to, const asset& quantity, const string& memo) {
-    auto sym = quantity.symbol;
-    check(sym.is_valid(), "invalid symbol name");
-    check(memo.size() <= 256, "memo has more than 256 bytes");
+void token::transfer(const name&    from, const name&    to, const asset&   quantity, const string&  memo) {
+    core().transfer(from, to, quantity, memo);
+}
 
-    stats statstable(get_self(), sym.code().raw());
-    auto existing = statstable.find(sym.code().raw());
-    check(existing != statstable.end(), "token with symbol does not exist, create token before issue");
-    const auto& st = *existing;
-    check(to == st.issuer, "tokens can only be issued to issuer account");
+void token::transfers(const name& from, const symbol& sym, const std::vector<transfer_entry>& transfers) {
+    core().transfers(from, sym, transfers);
+}
 
-    require_auth(st.issuer);
-    check(quantity.is_valid(), "invalid quantity");
-    check(quantity.amount > 0, "must issue positive quantity");
+void token::add_lock(const name& owner, const asset& value, const name& ram_payer, const currency_stats& st) {
+    auto [lock_time, granularity] = lock_config(st);
+    uint32_t release_time = current_time_point().sec_since_epoch() + lock_time;
+    release_time = release_time - (release_time % granularity);
 
-    check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
-    check(quantity.amount <= st.max_supply.amount - st.supply.amount, "quantity exceeds available supply");
+    lockpacks_mi packs(_self, owner.value);
+    auto pack = packs.find(value.symbol.code().raw());
+    if (pack == packs.end()) {
+        pack = migrate_locks(packs, owner, value.symbol.code(), ram_payer);
+    }
+    auto release = block_timestamp(time_point(seconds(release_time)));
+    if (pack == packs.end()) {
+        packs.emplace(ram_payer, [&](auto& p){
+            p.sym = value.symbol.code();
+            p.locked_total = value.amount;
+            p.earliest = release;
+            p.buckets.push_back({ release, uint64_t(value.amount) });
+        });
+        return;
+    }
 
-    statstable.modify(st, same_payer, [&](auto& s) {
-        s.supply += quantity;
+    auto updated = *pack;
+    drop_expired(updated, block_timestamp(current_time_point()));
+    auto itr = std::lower_bound(updated.buckets.begin(), updated.buckets.end(), release, [](const auto& b, const auto& t) {
+        return b.release_time < t;
     });
+    if (itr != updated.buckets.end() && itr->release_time == release) {
+        itr->amount += value.amount;
+    } else if (updated.buckets.size() < MAX_LOCK_BUCKETS) {
+        updated.buckets.insert(itr, { release, uint64_t(value.amount) });
+    } else if (itr != updated.buckets.end()) {
+        // full, join the nearest later bucket, the amount is released later but never early
+        itr->amount += value.amount;
+    } else {
+        // full and later than every bucket, the last bucket moves out to this release time
+        updated.buckets.back().release_time = release;
+        updated.buckets.back().amount += value.amount;
+    }
+    updated.locked_total += value.amount;
+    updated.earliest = updated.buckets.front().release_time;
 
-    add_balance(st.issuer, quantity, st.issuer, false);
+    // a longer row is billed to whoever pays for this transfer
+    bool grows = updated.buckets.size() > pack->buckets.size();
+    packs.modify(pack, grows ? ram_payer : same_payer, [&](auto& p){
+        p = updated;
+    });
 }
 
-void token::retire(const asset& quantity, const string& memo) {
-    auto sym = quantity.symbol;
-    check(sym.is_valid(), "invalid symbol name");
-    check(memo.size() <= 256, "memo has more than 256 bytes");
+std::pair<uint64_t, uint32_t> token::lock_config(const currency_stats& st) {
+    if (st.lock_time.has_value() && st.lock_granularity.has_value()) {
+        return { st.lock_time.value(), st.lock_granularity.value() };
+    }
+    // a symbol created before setlock takes the lock time from staking's symbols row and keeps it in stat
+    auto sym = st.supply.symbol.code();
+    stakingtable::symbols_mi symbols(STAKING_ACCOUNT, STAKING_ACCOUNT.value);
+    uint64_t lock_time = symbols.get(sym.raw(), "lock time not set").lock_time;
+    uint32_t granularity = lock_granularity(lock_time);
+
+    stats statstable(_self, sym.raw());
+    statstable.modify(statstable.get(sym.raw()), same_payer, [&](auto& s) {
+        s.lock_time = lock_time;
+        s.lock_granularity = granularity;
+    });
+    return { lock_time, granularity };
+}
 
-    stats statstable(get_self(), sym.code().raw());
-    auto existing = statstable.find(sym.code().raw());
-    check(existing != statstable.end(), "token with symbol does not exist");
-    const auto& st = *existing;
+bool token::check_lock(const name& owner, const asset& balance) {
+    auto sym = balance.symbol.code();
+    lockpacks_mi packs(_self, owner.value);
+    auto pack = packs.find(sym.raw());
+    if (pack == packs.end()) {
+        // a debit the owner did not sign, like burnfrom, cannot bill them for a pack, the old rows are read in place
+        if (!has_auth(owner)) {
+            return balance.amount >= locked_amount(owner, sym);
+        }
+        pack = migrate_locks(packs, owner, sym, owner);
+        if (pack == packs.end()) {
+            return true;
+        }
+    }
 
-    require_auth(st.issuer);
-    check(quantity.is_valid(), "invalid quantity");
-    check(quantity.amount > 0, "must retire positive quantity");
+    auto now_time = block_timestamp(current_time_point());
+    if (pack->earliest > now_time) {
+        return balance.amount >= int64_t(pack->locked_total);
+    }
+    auto updated = *pack;
+    drop_expired(updated, now_time);
+    if (updated.buckets.empty()) {
+        packs.erase(pack);
+        return true;
+    }
+    packs.modify(pack, same_payer, [&](auto& p){
+        p = updated;
+    });
+    return balance.amount >= int64_t(updated.locked_total);
+}
 
-    check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
+int64_t token::locked_amount(const name& owner, const symbol_code& sym) {
+    auto now_time = block_timestamp(current_time_point());
+    int64_t locked = 0;
 
-    statstable.modify(st, same_payer, [&](auto& s) {
-        s.supply -= quantity;
-   });
+    lockpacks_mi packs(_self, owner.value);
+    auto pack = packs.find(sym.raw());
+    if (pack != packs.end()) {
+        if (pack->earliest > now_time) {
+            return pack->locked_total;
+        }
+        for (auto itr = first_live(pack->buckets, now_time); itr != pack->buckets.end(); itr++) {
+            locked += itr->amount;
+        }
+        return locked;
+    }
 
-    sub_balance(st.issuer, quantity, false);
+    // not migrated yet
+    locks_mi locks_tb(_self, owner.value);
+    auto locks_idx = locks_tb.get_index<"bysym"_n>();
+    auto itr = locks_idx.find(sym.raw());
+    while (itr != locks_idx.end() && itr->sym == sym) {
+        if (itr->release_time > now_time) {
+            locked += itr->amount;
+        }
+        itr++;
+    }
+    return locked;
 }
 
-void token::transfer(const name&    from, const name&    to, const asset&   quantity, const string&  memo) {
-    check(from != to, "cannot transfer to self");
-    require_auth(from);
-    check(is_account(to), "to account does not exist");
-    auto sym = quantity.symbol.code();
-    stats statstable(get_self(), sym.raw());
-    const auto& st = statstable.get(sym.raw());
+token::lockpacks_mi::const_iterator token::migrate_locks(lockpacks_mi& packs, const name& owner, const symbol_code& sym, const name& ram_payer) {
+    // moves the live rows of the old one row per bucket `locks` table into a pack and erases them all
+    locks_mi locks_tb(_self, owner.value);
+    auto locks_idx = locks_tb.get_index<"bysym"_n>();
+    auto itr = locks_idx.find(sym.raw());
+    auto now_time = block_timestamp(current_time_point());
+    std::vector<lock_bucket> buckets;
+    while (itr != locks_idx.end() && itr->sym == sym) {
+        if (itr->release_time > now_time) {
+            buckets.push_back({ itr->release_time, itr->amount });
+        }
+        itr = locks_idx.erase(itr);
+    }
+    if (buckets.empty()) {
+        return packs.end();
+    }
 
-    require_recipient(from);
-    require_recipient(to);
+    std::sort(buckets.begin(), buckets.end(), [](const auto& a, const auto& b) {
+        return a.release_time < b.release_time;
+    });
+    st_lockpack pack { sym, 0, buckets.front().release_time, {} };
+    for (const auto& b : buckets) {
+        // lock id 0 was never matched, so old tables can hold two rows with the same release time
+        if (!pack.buckets.empty() && pack.buckets.back().release_time == b.release_time) {
+            pack.buckets.back().amount += b.amount;
+        } else {
+            pack.buckets.push_back(b);
+        }
+        pack.locked_total += b.amount;
+    }
+    return packs.emplace(ram_payer, [&](auto& p){
+        p = pack;
+    });
+}
 
-    check(quantity.is_valid(), "invalid quantity");
-    check(quantity.amount > 0, "must transfer positive quantity");
-    check(quantity.symbol == st.supply.symbol, "symbol precision mismatch");
-    check(memo.size() <= 256, "memo has more than 256 bytes");
+std::vector<token::lock_bucket>::const_iterator token::first_live(const std::vector<lock_bucket>& buckets, const block_timestamp& now_time) {
+    return std::upper_bound(buckets.begin(), buckets.end(), now_time, [](const auto& t, const auto& b) {
+        return t < b.release_time;
+    });
+}
 
-    auto payer = has_auth(to) ? to : from;
+void token::drop_expired(st_lockpack& pack, const block_timestamp& now_time) {
+    auto live = first_live(pack.buckets, now_time);
+    for (auto itr = pack.buckets.begin(); itr != live; itr++) {
+        pack.locked_total -= itr->amount;
+    }
+    pack.buckets.erase(pack.buckets.begin(), live);
+    pack.earliest = pack.buckets.empty() ? block_timestamp() : pack.buckets.front().release_time;
+}
 
-    sub_balance(from, quantity, from != st.issuer);
-    add_balance(to, quantity, payer, to != st.issuer);
+asset token::getspendable(const name& owner, const symbol_code& sym) {
+    stats statstable(get_self(), sym.raw());
+    const auto& st = statstable.get(sym.raw(), "symbol does not exist");
 
+    accounts acnts(get_self(), owner.value);
+    auto it = acnts.find(sym.raw());
+    if (it == acnts.end()) {
+        return asset(0, st.supply.symbol);
+    }
+    if (owner == st.issuer) {
+        return it->balance;
+    }
+    auto spendable = it->balance;
+    spendable.amount = std::max(spendable.amount - locked_amount(owner, sym), int64_t(0));
+    return spendable;
 }
 
-void token::sub_balance(const name& owner, const asset& value, bool is_check) {
-    accounts from_acnts(get_self(), owner.value);
-
-    const auto& from = from_acnts.get(value.symbol.code().raw(), "no balance object found");
-    check(from.balance.amount >= value.amount, "overdrawn balance");
-    check(!is_check || check_lock(owner, from.balance - value), "transfer amount is greater than locked");
+void token::setlock(const symbol_code& sym, uint64_t lock_time, uint32_t granularity) {
+    stats statstable(get_self(), sym.raw());
+    const auto& st = statstable.get(sym.raw(), "symbol does not exist");
+    require_auth(st.issuer);
+    // a bucket wider than the lock rounds most release times down to now or earlier
+    check(granularity <= lock_time, "granularity is longer than the lock time");
 
-    from_acnts.modify(from, owner, [&](auto& a) {
-        a.balance -= value;
+    statstable.modify(st, same_payer, [&](auto& s) {
+        s.lock_time = lock_time;
+        s.lock_granularity = granularity > 0 ? granularity : lock_granularity(lock_time);
     });
 }
 
-void token::add_balance(const name& owner, const asset& value, const name& ram_payer, bool add_lock) {
-    accounts to_acnts(get_self(), owner.value);
-    auto to = to_acnts.find(value.symbol.code().raw());
-    if (to == to_acnts.end()) {
-        to_acnts.emplace(ram_payer, [&](auto& a){
-            a.balance = value;
-        });
-    } else {
-        to_acnts.modify(to, same_payer, [&](auto& a) {
-            a.balance += value;
-        });
-    }
-
-    if (!add_lock) {
-        return;
-    }
-
-    // add lock
-    stakingtable::symbols_mi symbols_tb(STAKING_ACCOUNT, STAKING_ACCOUNT.value);
-    auto s_itr = symbols_tb.require_find(value.symbol.code().raw(), "Staked symbol not found");
-    // STAKING_ACCOUNT
-    uint32_t release_time = current_time_point().sec_since_epoch() + s_itr->lock_time;
+uint32_t token::lock_granularity(uint64_t lock_time) {
     uint32_t dayseconds = 86400;
-    uint32_t weekseconds = dayseconds * 7; 
-    uint32_t monthseconds = dayseconds * 30; 
-    if (s_itr->lock_time >= monthseconds * 3) {
+    uint32_t weekseconds = dayseconds * 7;
+    uint32_t monthseconds = dayseconds * 30;
+    if (lock_time >= monthseconds * 3) {
         // group by weeks
-        release_time = release_time - (release_time % weekseconds);
-    } else if (s_itr->lock_time >= monthseconds) {
+        return weekseconds;
+    } else if (lock_time >= monthseconds) {
         // group by days
-        release_time = release_time - (release_time % dayseconds);
-    } else if (s_itr->lock_time >= dayseconds) {
+        return dayseconds;
+    } else if (lock_time >= dayseconds) {
         // group by hours
-        release_time = release_time - (release_time % 3600);
-    } else {
-        // group by minutes
-        release_time = release_time - (release_time % 60);
+        return 3600;
     }
+    // group by minutes
+    return 60;
+}
 
-    locks_mi locks_tb(_self, owner.value);
-    auto locks_idx = locks_tb.get_index<"bysym"_n>();
-    auto itr = locks_idx.find(value.symbol.code().raw());
+void token::prunelocks(const std::vector<name>& owners, const symbol_code& sym, uint32_t max_rows) {
+    check(owners.size() > 0, "no owners to prune");
+    check(max_rows > 0, "max_rows must be positive");
+
+    // every rewritten or erased row counts against max_rows
     auto now_time = block_timestamp(current_time_point());
-    int count = 0;
-    uint64_t lock_id = 0;
-    while (itr != locks_idx.end() && itr->sym == value.symbol.code()) {
-        if (itr->release_time.to_time_point().sec_since_epoch() == release_time) {
-            lock_id = itr->lock_id;
+    uint32_t rows = 0;
+    for (const auto& owner : owners) {
+        if (rows >= max_rows) {
             break;
         }
-        if (itr->release_time <= now_time) {
-            itr = locks_idx.erase(itr);
-            continue;
-        } 
-        // print_f("% % % %\n", itr->lock_id, itr->release_time.to_string(), itr->sym, value.symbol.code());
-        check(++count < 20, "too much staked");
-        itr++;
-    }
+        lockpacks_mi packs(_self, owner.value);
+        auto pack = packs.find(sym.raw());
+        if (pack != packs.end() && pack->earliest <= now_time) {
+            auto updated = *pack;
+            drop_expired(updated, now_time);
+            if (updated.buckets.empty()) {
+                packs.erase(pack);
+            } else {
+                packs.modify(pack, same_payer, [&](auto& p){
+                    p = updated;
+                });
+            }
+            rows++;
+        }
 
-    if (lock_id > 0) {
-        auto mitr = locks_tb.find(lock_id);
-        locks_tb.modify(mitr, same_payer, [&](auto& a){
-            a.amount += value.amount;
-        });
-    } else {
-        locks_tb.emplace(ram_payer, [&](auto& a){
-            a.lock_id = locks_tb.available_primary_key();
-            a.release_time = time_point(seconds(release_time));
-            a.sym = value.symbol.code();
-            a.amount = value.amount;
-        });
+        locks_mi locks_tb(_self, owner.value);
+        auto locks_idx = locks_tb.get_index<"bysym"_n>();
+        auto itr = locks_idx.find(sym.raw());
+        while (itr != locks_idx.end() && itr->sym == sym && rows < max_rows) {
+            if (itr->release_time <= now_time) {
+                itr = locks_idx.erase(itr);
+                rows++;
+            } else {
+                itr++;
+            }
+        }
     }
-
 }
 
-bool token::check_lock(const name& owner, const asset& balance) {
-    auto balance_amount = balance.amount;
+void token::migratelocks(const name& owner, const symbol_code& sym, const name& ram_payer) {
+    require_auth(ram_payer);
+
+    lockpacks_mi packs(_self, owner.value);
+    check(packs.find(sym.raw()) == packs.end(), "locks already migrated");
     locks_mi locks_tb(_self, owner.value);
     auto locks_idx = locks_tb.get_index<"bysym"_n>();
-    auto itr = locks_idx.find(balance.symbol.code().raw());
-    auto now_time = block_timestamp(current_time_point());
-    while (itr != locks_idx.end() && itr->sym == balance.symbol.code()) {
-        if (itr->release_time <= now_time) {
-            itr = locks_idx.erase(itr);
-            continue;
-        }
-        balance_amount -= itr->amount;
-        if (balance_amount < 0) {
-            return false;
-        }
-        itr++;
-    }
-    return true;
+    auto itr = locks_idx.find(sym.raw());
+    check(itr != locks_idx.end() && itr->sym == sym, "no locks to migrate");
+    migrate_locks(packs, owner, sym, ram_payer);
 }
 
 void token::open(const name& owner, const symbol& symbol, const name& ram_payer) {
-    require_auth(ram_payer);
+    core().open(owner, symbol, ram_payer);
+}
 
-    check(is_account(owner ), "owner account does not exist");
+void token::close(const name& owner, const symbol& symbol) {
+    core().close(owner, symbol);
+}
 
-    auto sym_code_raw = symbol.code().raw();
-    stats statstable(get_self(), sym_code_raw);
-    const auto& st = statstable.get(sym_code_raw, "symbol does not exist");
-    check(st.supply.symbol == symbol, "symbol precision mismatch");
+void token::erase_locks(const name& owner, const symbol_code& sym) {
+    // a zero balance has nothing left locked, the lock rows go with it
+    lockpacks_mi packs(_self, owner.value);
+    auto pack = packs.find(sym.raw());
+    if (pack != packs.end()) {
+        packs.erase(pack);
+    }
+    locks_mi locks_tb(_self, owner.value);
+    auto locks_idx = locks_tb.get_index<"bysym"_n>();
+    auto itr = locks_idx.find(sym.raw());
+    while (itr != locks_idx.end() && itr->sym == sym) {
+        itr = locks_idx.erase(itr);
+    }
+}
 
-    accounts acnts(get_self(), owner.value);
-    auto it = acnts.find(sym_code_raw);
-    if (it == acnts.end()) {
-        acnts.emplace(ram_payer, [&](auto& a){
-            a.balance = asset{0, symbol};
-        });
+void token::dispatch(uint64_t receiver, uint64_t code, uint64_t action) {
+    if (code != receiver) {
+        return;
+    }
+    if (action == "transfer"_n.value || action == "issue"_n.value || action == "issueto"_n.value || action == "retire"_n.value) {
+        actiondata::reader<actiondata::MAX_MEMO_ACTION_SIZE> data;
+        name from, to;
+        asset quantity;
+        std::string_view memo;
+        if (action == "transfer"_n.value && data.read(from, to, quantity, memo)) {
+            token(name(receiver), name(code), data.stream()).core().transfer(from, to, quantity, memo);
+            return;
+        }
+        if (action == "issue"_n.value && data.read(to, quantity, memo)) {
+            token(name(receiver), name(code), data.stream()).core().issue(to, quantity, memo);
+            return;
+        }
+        if (action == "issueto"_n.value && data.read(to, quantity, memo)) {
+            token(name(receiver), name(code), data.stream()).core().issueto(to, quantity, memo);
+            return;
+        }
+        if (action == "retire"_n.value && data.read(quantity, memo)) {
+            token(name(receiver), name(code), data.stream()).core().retire(quantity, memo);
+            return;
+        }
+    }
+    switch (action) {
+        case "getspendable"_n.value:
+            actiondata::execute_query(name(receiver), name(code), &token::getspendable);
+            break;
+        EOSIO_DISPATCH_HELPER(token, (create)(issue)(issueto)(retire)(burnfrom)(transfer)(transfers)(open)(close)(prunelocks)(setlock)(migratelocks))
     }
 }
 
-void token::close(const name& owner, const symbol& symbol) {
-    require_auth(owner);
-    accounts acnts(get_self(), owner.value);
-    auto it = acnts.find(symbol.code().raw());
-    check(it != acnts.end(), "Balance row already deleted or never existed. Action won't have any effect.");
-    check(it->balance.amount == 0, "Cannot close because the balance is not zero.");
-    acnts.erase(it);
-}
\ No newline at end of file
+extern "C" {
+    void apply(uint64_t receiver, uint64_t code, uint64_t action) {
+        token::dispatch(receiver, code, action);
+    }
+}
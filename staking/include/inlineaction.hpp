@@ -0,0 +1,94 @@
+#pragma once
+
+#include <eosio/action.hpp>
+#include <eosio/asset.hpp>
+#include <eosio/datastream.hpp>
+
+#include <cstddef>
+
+// serializes staking's fixed shape token actions straight into one buffer and sends them,
+// instead of packing a tuple, then the action, into two new vectors for every send
+namespace inlineaction {
+
+    using namespace eosio;
+
+    // a memo serialized at compile time, the one byte length then the text
+    template<size_t N>
+    struct memo {
+        static_assert(N <= 64, "memo too long for the encoder buffer");
+        char bytes[N] {};
+
+        constexpr memo(const char (&text)[N]) {
+            bytes[0] = char(N - 1);
+            for (size_t i = 0; i + 1 < N; i++) {
+                bytes[i + 1] = text[i];
+            }
+        }
+    };
+
+    /**
+     * Sends `issueto`, `transfer`, `retire` and `burnfrom` actions authorized by `actor@active`. The
+     * authorization is serialized once when the encoder is made, each send only writes
+     * the receiver, action name and payload into the same buffer before `send_inline`.
+     */
+    class encoder {
+        public:
+            explicit encoder(name actor) {
+                datastream<char*> ds(_buffer + 16, AUTH_SIZE);
+                ds << unsigned_int(1) << actor << name("active");
+            }
+
+            template<size_t N>
+            void issueto(name contract, name to, const asset& quantity, const memo<N>& m) {
+                auto ds = start<8 + 16 + N>(contract, name("issueto"));
+                ds << to << quantity;
+                finish(ds, m);
+            }
+
+            template<size_t N>
+            void transfer(name contract, name from, name to, const asset& quantity, const memo<N>& m) {
+                auto ds = start<8 + 8 + 16 + N>(contract, name("transfer"));
+                ds << from << to << quantity;
+                finish(ds, m);
+            }
+
+            template<size_t N>
+            void retire(name contract, const asset& quantity, const memo<N>& m) {
+                auto ds = start<16 + N>(contract, name("retire"));
+                ds << quantity;
+                finish(ds, m);
+            }
+
+            void burnfrom(name contract, name owner, const asset& quantity) {
+                auto ds = start<8 + 16>(contract, name("burnfrom"));
+                ds << owner << quantity;
+                internal_use_do_not_use::send_inline(_buffer, ds.tellp());
+            }
+
+        private:
+            // one authorization: the count, actor and permission
+            static constexpr size_t AUTH_SIZE = 1 + 8 + 8;
+            // receiver, action name, authorization, a one byte data size and the largest payload
+            static constexpr size_t HEADER_SIZE = 8 + 8 + AUTH_SIZE + 1;
+            static constexpr size_t MAX_DATA_SIZE = 8 + 8 + 16 + 64;
+
+            char _buffer[HEADER_SIZE + MAX_DATA_SIZE];
+
+            template<size_t DataSize>
+            datastream<char*> start(name contract, name act) {
+                static_assert(DataSize < 128 && DataSize <= MAX_DATA_SIZE, "payload needs a one byte size");
+                datastream<char*> ds(_buffer, sizeof(_buffer));
+                ds << contract << act;
+                ds.skip(AUTH_SIZE);
+                ds << char(DataSize);
+                return ds;
+            }
+
+            template<size_t N>
+            void finish(datastream<char*>& ds, const memo<N>& m) {
+                ds.write(m.bytes, N);
+                internal_use_do_not_use::send_inline(_buffer, ds.tellp());
+            }
+    };
+
+}
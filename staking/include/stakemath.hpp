@@ -0,0 +1,49 @@
+#pragma once
+
+#include <fixedmath.hpp>
+
+// the staking contract's supply and exchange arithmetic on raw amounts, shared with the native simulator
+// so a simulated epoch rounds exactly like distribute, stake and unstake do
+namespace stakemath {
+
+    using fixedmath::u128;
+
+    // rates are per RATE_BASE per epoch
+    constexpr uint64_t RATE_BASE = 1000000;
+    constexpr uint64_t MAX_AMOUNT = (uint64_t(1) << 62) - 1;
+
+    // the supply grows by the summed rate once for every epoch, saturating at the asset maximum. One
+    // step per epoch keeps the rounding of epoch by epoch distribution, callers bound `epochs`
+    constexpr uint64_t compound(uint64_t supply, uint64_t rate, uint64_t epochs) {
+        u128 compounded = supply;
+        for (uint64_t i = 0; i < epochs && compounded <= MAX_AMOUNT; i++) {
+            compounded += fixedmath::mul_div(uint64_t(compounded), rate, RATE_BASE);
+        }
+        return compounded > MAX_AMOUNT ? MAX_AMOUNT : uint64_t(compounded);
+    }
+
+    // each symbol takes its rate's share of the supply growth
+    constexpr uint64_t share(uint64_t growth, uint64_t rate, uint64_t total_rate) {
+        return fixedmath::mul_div(growth, rate, total_rate);
+    }
+
+    // Q64.64 issued per locked, an empty pool stakes one to one
+    constexpr u128 stake_index(uint64_t locked, uint64_t issued) {
+        return locked == 0 || issued == 0 ? fixedmath::one : fixedmath::to_q64(issued, locked);
+    }
+
+    // Q64.64 locked per issued
+    constexpr u128 unstake_index(uint64_t locked, uint64_t issued) {
+        return issued == 0 ? fixedmath::one : fixedmath::to_q64(locked, issued);
+    }
+
+    // an amount converted at a cached index, rounded down in the pool's favour
+    constexpr uint64_t convert(uint64_t amount, u128 index) {
+        return uint64_t(fixedmath::mul_q64(amount, index));
+    }
+
+    static_assert(compound(1000000, 1000, 2) == 1002001);
+    static_assert(convert(300, stake_index(200, 100)) == 150);
+    static_assert(convert(150, unstake_index(200, 100)) == 300);
+
+}
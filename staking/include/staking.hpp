@@ -1,7 +1,18 @@
+#pragma once
+
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
 #include <eosio/system.hpp>
 #include <eosio/singleton.hpp>
+#include <eosio/binary_extension.hpp>
+
+#include <actiondata.hpp>
+#include <fixedmath.hpp>
+#include <inlineaction.hpp>
+#include <stakemath.hpp>
+
+#include <map>
+#include <vector>
 
 using namespace eosio;
 using std::string;
@@ -10,6 +21,14 @@ using std::string;
 #define TOKEN_SYMBOL symbol("IFT", 8)
 #define ADMIN_ACCOUNT name("admin.ift")
 #define TOKEN_ISSUER name("issuer.ift")
+// max symbols distributed by one distribute call
+#define DISTRIBUTE_PAGE_SIZE 10
+// max issueto steps one call mints, the rest is carried in the epoch row
+#define MAX_ISSUE_STEPS 10
+// max epochs one distribution catches up, the rest start over on the next call
+#define MAX_CATCHUP_EPOCHS 1000
+// largest weight of one symbol in a split stake memo
+#define MAX_SPLIT_WEIGHT 1000000
 
 struct currency_stats {
     asset    supply;
@@ -25,37 +44,61 @@ inline asset get_supply(name account, symbol_code sc) {
     return itr->supply;
 }
 
+struct stake_entry {
+    name owner;
+    asset quantity;
+    symbol_code sc;
+};
+
 CONTRACT staking : public contract {
     public:
         staking(name receiver, name code, datastream<const char *> ds): contract(receiver, code, ds),
                 _epochs(_self, _self.value),
-                _symbols(_self, _self.value) {
-            if (_epochs.exists()) {
-                _epoch = _epochs.get();
-            } else {
-                _epoch = { 28800, 0, 0, asset(0, TOKEN_SYMBOL) };
-            }
-        }
+                _symbols(_self, _self.value) {}
         
         ACTION init(uint64_t number, uint64_t length, uint64_t start_time);
         ACTION distribute();
         ACTION addsymbol(symbol sym, name sname, uint64_t rate, uint64_t lock_time);
         ACTION removesymbol(symbol_code sc);
         ACTION updaterate(symbol_code sc, uint64_t rate);
+        ACTION updatelock(symbol_code sc, uint64_t lock_time, uint32_t granularity);
 
         ACTION stake(name from, asset quantity, symbol_code sc);
         ACTION unstake(name from, asset quantity, name code, symbol sym);
+        // burns the owner's staked tokens on their contract and releases IFT, without transferring them here first
+        ACTION unstakeburn(name owner, asset quantity);
+
+        // read only queries, computed the same way unstake and distribute do
+        [[eosio::action, eosio::read_only]] asset getrate(symbol_code sc);
+        [[eosio::action, eosio::read_only]] uint64_t nextepoch();
+
+        ACTION stakebatch(name relayer, std::vector<stake_entry> entries);
+        ACTION withdraw(name relayer, asset quantity);
 
         [[eosio::on_notify("*::transfer")]]
         void ontransfer(name from, name to, asset quantity, string memo);
 
+        // whether `code` is the contract of a staked symbol, checked by apply before dispatching a transfer
+        static bool is_staked_token(name self, name code, symbol sym);
+        // the contract's apply, incoming transfers are filtered and decoded in place with the memo as a view
+        static void dispatch(uint64_t receiver, uint64_t code, uint64_t action);
 
-    private:
+
+        // the rows are public so native tools can decode table dumps with these structs
         TABLE epoch {
             uint64_t length;
             uint64_t number;
             uint64_t end_time;
             asset distribute;
+            // IFT supply snapshot every symbol of the epoch distributes against
+            binary_extension<uint64_t> supply;
+            // raw code of the next symbol to distribute, 0 when the epoch is done
+            binary_extension<uint64_t> cursor;
+            // sum of the symbol rates and the IFT minted over all epochs being caught up
+            binary_extension<uint64_t> rate;
+            binary_extension<uint64_t> growth;
+            // IFT already distributed to the symbols and not minted yet
+            binary_extension<uint64_t> unminted;
         };
         TABLE st_symbol {
             symbol sym;
@@ -65,18 +108,52 @@ CONTRACT staking : public contract {
             asset distribute;
             asset locked;
             asset issued;
+            // Q64.64 issued per locked and locked per issued, refreshed on distribute
+            binary_extension<uint128_t> stake_index;
+            binary_extension<uint128_t> unstake_index;
+            // number of the epoch whose share was last paid in, a stake during a paged distribution pays it early
+            binary_extension<uint64_t> paid_epoch;
             uint64_t primary_key() const { return sym.code().raw(); }
         };
+        // IFT a relayer transferred with the "deposit" memo, spent by stakebatch
+        TABLE deposit {
+            name owner;
+            asset balance;
+            uint64_t primary_key() const { return owner.value; }
+        };
         typedef multi_index<"symbols"_n, st_symbol> symbols_mi;
+        typedef multi_index<"deposits"_n, deposit> deposits_mi;
         typedef singleton<"epoch"_n, epoch> epoch_sig;
-        
-        
+
+    private:
         symbols_mi _symbols;
         epoch_sig _epochs;
         epoch _epoch;
+        bool _epoch_loaded = false;
+
+        // reads the epoch singleton on first use, notifications that are ignored never touch it
+        void _load_epoch();
+
+        void _ontransfer(name from, name to, const asset &quantity, std::string_view memo);
+        void _stake(name from, asset quantity, std::string_view memo);
+        void _unstake(name from, asset quantity, name code, symbol sym, bool burn);
+        void _apply_stake(name owner, asset quantity, symbol_code sc);
+        void _apply_unstake(name owner, asset quantity, name code, symbol sym, bool burn);
+        void _setlock(const st_symbol &s, uint32_t granularity);
+        void _deposit(name owner, asset quantity);
+        void _sub_deposit(name owner, asset quantity);
+
+        bool _distribute_due();
+        void _distribute_page();
+
+        uint64_t _distribute(symbols_mi::const_iterator sym_itr, uint64_t growth, uint64_t total_rate);
+        uint64_t _pending_share(const st_symbol &s);
+        void _settle(symbols_mi::const_iterator sym_itr);
+        void _issue(uint64_t amount);
 
-        void _stake(name from, asset quantity, symbol_code sc);
-        void _unstake(name from, asset quantity, name code, symbol sym);
+        static void _refresh_index(st_symbol &s);
+        static uint128_t _stake_index(const st_symbol &s);
+        static uint128_t _unstake_index(const st_symbol &s);
 
-        uint64_t _distribute(symbols_mi::const_iterator sym_itr, uint64_t ift_supply);
+        static uint64_t _compound(uint64_t supply, uint64_t rate, uint64_t epochs);
 };
\ No newline at end of file
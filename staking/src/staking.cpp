@@ -1,21 +1,36 @@
 #include <staking.hpp>
 
+static constexpr inlineaction::memo MEMO_STAKE("stake");
+static constexpr inlineaction::memo MEMO_UNSTAKE("unstake");
+static constexpr inlineaction::memo MEMO_UNSTAKE_RETIRE("unstake retire");
+static constexpr inlineaction::memo MEMO_DISTRIBUTE("distribute");
+static constexpr inlineaction::memo MEMO_WITHDRAW("withdraw");
+
 void staking::ontransfer(name from, name to, asset quantity, string memo) {
+    _ontransfer(from, to, quantity, memo);
+}
+
+void staking::_ontransfer(name from, name to, const asset &quantity, std::string_view memo) {
     if (to != get_self() || from == get_self() || from == TOKEN_ISSUER) {
         return;
     }
     auto code = get_first_receiver();
     auto sym = quantity.symbol;
     if (code == TOKEN_CONTRACT && sym == TOKEN_SYMBOL) {
-        _stake(from, quantity, symbol_code(memo));
+        if (memo == "deposit") {
+            _deposit(from, quantity);
+            return;
+        }
+        _stake(from, quantity, memo);
     } else {
-        _unstake(from, quantity, code, sym);
+        _unstake(from, quantity, code, sym, false);
     }
 }
 
 
 void staking::init(uint64_t number, uint64_t length, uint64_t start_time) {
     require_auth(ADMIN_ACCOUNT);
+    _load_epoch();
     check(_epoch.number == 0, "Epoch has inited");
     _epoch.number = number;
     _epoch.length = length;
@@ -25,6 +40,8 @@ void staking::init(uint64_t number, uint64_t length, uint64_t start_time) {
 
 void staking::addsymbol(symbol sym, name sname, uint64_t rate, uint64_t lock_time) {
     require_auth(ADMIN_ACCOUNT);
+    _load_epoch();
+    check(_epoch.cursor.value_or(0) == 0, "Distribution in progress");
     auto supply = get_supply(sname, sym.code());
     check(supply.amount == 0, "The staked symbol has supplied");
     _symbols.emplace(_self, [&](auto &s) {
@@ -35,7 +52,10 @@ void staking::addsymbol(symbol sym, name sname, uint64_t rate, uint64_t lock_tim
          s.distribute = asset(0, TOKEN_SYMBOL);
          s.locked = asset(0, TOKEN_SYMBOL);
          s.issued = asset(0, sym);
+         s.stake_index = fixedmath::one;
+         s.unstake_index = fixedmath::one;
     });
+    _setlock(_symbols.get(sym.code().raw()), 0);
 }
 
 void staking::removesymbol(symbol_code sc) {
@@ -47,119 +67,476 @@ void staking::removesymbol(symbol_code sc) {
 
 void staking::updaterate(symbol_code sc, uint64_t rate) {
     require_auth(ADMIN_ACCOUNT);
+    _load_epoch();
     check(rate < 1000000, "Rate too large");
+    check(_epoch.cursor.value_or(0) == 0, "Distribution in progress");
     auto itr = _symbols.require_find(sc.raw(), "Staked symbol not found");
     _symbols.modify(itr, same_payer, [&](auto &s) {
         s.rate = rate;
     });
 }
 
+void staking::updatelock(symbol_code sc, uint64_t lock_time, uint32_t granularity) {
+    require_auth(ADMIN_ACCOUNT);
+    check(granularity <= lock_time, "Granularity longer than lock time");
+    auto itr = _symbols.require_find(sc.raw(), "Staked symbol not found");
+    _symbols.modify(itr, same_payer, [&](auto &s) {
+        s.lock_time = lock_time;
+    });
+    _setlock(*itr, granularity);
+}
+
 void staking::distribute() {
-    auto now_ts = current_time_point().sec_since_epoch();
-    if (now_ts > _epoch.end_time) {
-        _epoch.number++;
-        _epoch.end_time += _epoch.length;
-        uint64_t total_distribute = 0;
-        uint64_t ift_supply = get_supply(TOKEN_CONTRACT, TOKEN_SYMBOL.code()).amount;
-        auto itr = _symbols.begin();
-        while (itr != _symbols.end()) {
-            if (itr->rate > 0) {
-                total_distribute += _distribute(itr, ift_supply);
+    _distribute_page();
+}
+
+
+void staking::stake(name owner, asset quantity, symbol_code staked_sc) {
+    require_auth(_self);
+    _apply_stake(owner, quantity, staked_sc);
+}
+
+void staking::unstake(name owner, asset quantity, name code, symbol sym) {
+    require_auth(_self);
+    _apply_unstake(owner, quantity, code, sym, false);
+}
+
+void staking::unstakeburn(name owner, asset quantity) {
+    require_auth(owner);
+    auto itr = _symbols.require_find(quantity.symbol.code().raw(), "Staked symbol not found");
+    _unstake(owner, quantity, itr->sname, quantity.symbol, true);
+}
+
+asset staking::getrate(symbol_code sc) {
+    // IFT released for unstaking one whole staked token
+    auto itr = _symbols.require_find(sc.raw(), "Staked symbol not found");
+    uint64_t unit = 1;
+    for (uint8_t i = 0; i < itr->sym.precision(); i++) {
+        unit *= 10;
+    }
+    // a share the paged distribution has not reached yet is paid before an unstake
+    uint64_t pending = _pending_share(*itr);
+    if (pending > 0) {
+        return asset(stakemath::convert(unit, stakemath::unstake_index(itr->locked.amount + pending, itr->issued.amount)), TOKEN_SYMBOL);
+    }
+    return asset(stakemath::convert(unit, _unstake_index(*itr)), TOKEN_SYMBOL);
+}
+
+uint64_t staking::nextepoch() {
+    // seconds until distribute has work, 0 when it is due or a distribution is in progress
+    _load_epoch();
+    check(_epoch.number > 0, "Epoch not inited");
+    if (_distribute_due()) {
+        return 0;
+    }
+    return _epoch.end_time - current_time_point().sec_since_epoch() + 1;
+}
+
+void staking::stakebatch(name relayer, std::vector<stake_entry> entries) {
+    require_auth(relayer);
+    _load_epoch();
+    check(_epoch.number > 0, "Stake not started");
+    check(entries.size() > 0, "Empty batch");
+
+    // merge the entries per symbol and owner, so every st_symbol row is written once
+    asset total(0, TOKEN_SYMBOL);
+    std::map<symbol_code, std::map<name, asset>> groups;
+    for (auto &e : entries) {
+        check(e.quantity.symbol == TOKEN_SYMBOL, "Invalid token");
+        check(e.quantity.amount > 10000000LL, "The stake amount must be greater than 0.1");
+        check(is_account(e.owner), "Owner account does not exist");
+        total += e.quantity;
+        auto res = groups[e.sc].emplace(e.owner, e.quantity);
+        if (!res.second) {
+            res.first->second += e.quantity;
+        }
+    }
+    _sub_deposit(relayer, total);
+
+    if (_distribute_due()) {
+        _distribute_page();
+    }
+
+    inlineaction::encoder out(_self);
+    for (auto &group : groups) {
+        auto itr = _symbols.require_find(group.first.raw(), "Staked symbol not found");
+        _settle(itr);
+
+        uint128_t index = _stake_index(*itr);
+        asset locked(0, TOKEN_SYMBOL);
+        asset issued(0, itr->sym);
+        std::vector<std::pair<name, asset>> issues;
+        issues.reserve(group.second.size());
+        for (auto &owner : group.second) {
+            auto new_issue = asset(stakemath::convert(owner.second.amount, index), itr->sym);
+            locked += owner.second;
+            issued += new_issue;
+            issues.emplace_back(owner.first, new_issue);
+        }
+        bool empty = itr->issued.amount == 0;
+        _symbols.modify(itr, same_payer, [&](auto &s) {
+            s.locked += locked;
+            s.issued += issued;
+            if (empty || !s.stake_index.has_value()) {
+                _refresh_index(s);
             }
-            itr++;
+        });
+
+        for (auto &issue : issues) {
+            out.issueto(itr->sname, issue.first, issue.second, MEMO_STAKE);
         }
-        _epoch.distribute.amount = total_distribute;
-        _epochs.set(_epoch, _self);
     }
-    
 }
 
+void staking::withdraw(name relayer, asset quantity) {
+    require_auth(relayer);
+    check(quantity.symbol == TOKEN_SYMBOL, "Invalid token");
+    check(quantity.amount > 0, "Withdraw need greater than zero");
+    _sub_deposit(relayer, quantity);
 
-void staking::stake(name owner, asset quantity, symbol_code staked_sc) {
-    require_auth(_self);
+    inlineaction::encoder(_self).transfer(TOKEN_CONTRACT, _self, relayer, quantity, MEMO_WITHDRAW);
+}
 
+bool staking::_distribute_due() {
+    // an epoch ended, pages are left or IFT of the last distribution is left to mint
+    auto now_ts = current_time_point().sec_since_epoch();
+    return now_ts > _epoch.end_time || _epoch.cursor.value_or(0) != 0 || _epoch.unminted.value_or(0) > 0;
+}
+
+void staking::_distribute_page() {
+    _load_epoch();
+    check(_epoch.number > 0, "Epoch not inited");
+    if (_epoch.cursor.value_or(0) == 0) {
+        auto now_ts = current_time_point().sec_since_epoch();
+        if (now_ts <= _epoch.end_time) {
+            if (_epoch.unminted.value_or(0) > 0) {
+                _issue(0);
+                _epochs.set(_epoch, _self);
+            }
+            return;
+        }
+        // catch up the epochs that ended since the last distribution at once, compound loops once per
+        // epoch so a long halt is caught up MAX_CATCHUP_EPOCHS at a time
+        uint64_t epochs = 1;
+        if (_epoch.length > 0) {
+            epochs += (now_ts - _epoch.end_time - 1) / _epoch.length;
+        }
+        epochs = std::min<uint64_t>(epochs, MAX_CATCHUP_EPOCHS);
+        _epoch.number += epochs;
+        _epoch.end_time += epochs * _epoch.length;
+        _epoch.distribute.amount = 0;
+
+        uint64_t total_rate = 0;
+        for (auto itr = _symbols.begin(); itr != _symbols.end(); itr++) {
+            total_rate += itr->rate;
+        }
+        // IFT still to mint is part of the supply the next epochs grow
+        uint64_t ift_supply = get_supply(TOKEN_CONTRACT, TOKEN_SYMBOL.code()).amount + _epoch.unminted.value_or(0);
+        _epoch.supply = ift_supply;
+        _epoch.rate = total_rate;
+        _epoch.growth = _compound(ift_supply, total_rate, epochs) - ift_supply;
+        auto first = _symbols.begin();
+        _epoch.cursor = first == _symbols.end() ? 0 : first->sym.code().raw();
+    }
+
+    uint64_t growth = _epoch.growth.value();
+    uint64_t total_rate = _epoch.rate.value();
+    uint64_t page_distribute = 0;
+    auto itr = _symbols.lower_bound(_epoch.cursor.value());
+    for (int count = 0; itr != _symbols.end() && count < DISTRIBUTE_PAGE_SIZE; count++) {
+        if (itr->rate > 0 && itr->paid_epoch.value_or(0) != _epoch.number) {
+            page_distribute += _distribute(itr, growth, total_rate);
+        }
+        itr++;
+    }
+    // one mint for the whole page, the per symbol amounts stay in st_symbol.distribute
+    _issue(page_distribute);
+    _epoch.distribute.amount += page_distribute;
+    _epoch.cursor = itr == _symbols.end() ? 0 : itr->sym.code().raw();
+    _epochs.set(_epoch, _self);
+}
+
+
+void staking::_apply_stake(name owner, asset quantity, symbol_code staked_sc) {
     check(quantity.amount > 10000000LL, "The stake amount must be greater than 0.1");
     auto itr = _symbols.require_find(staked_sc.raw(), "Staked symbol not found");
+    _settle(itr);
 
-    
-    uint128_t ratio = 100000000LL;
-    if (itr->locked.amount > 0 && itr->issued.amount > 0) {
-        ratio = ratio * itr->issued.amount / itr->locked.amount;
-    }
-    auto new_issue = asset(quantity.amount * ratio / 100000000LL, itr->sym);
+    auto new_issue = asset(stakemath::convert(quantity.amount, _stake_index(*itr)), itr->sym);
+    bool empty = itr->issued.amount == 0;
     _symbols.modify(itr, same_payer, [&](auto &s) {
         s.locked += quantity;
         s.issued += new_issue;
+        if (empty || !s.stake_index.has_value()) {
+            _refresh_index(s);
+        }
     });
     
-    auto data1 = std::make_tuple(_self, new_issue, string("stake"));
-    action(permission_level{_self, "active"_n}, itr->sname, "issue"_n, data1).send();
-    auto data2 = std::make_tuple(_self, owner, new_issue, string("stake"));
-    action(permission_level{_self, "active"_n}, itr->sname, "transfer"_n, data2).send();
+    inlineaction::encoder(_self).issueto(itr->sname, owner, new_issue, MEMO_STAKE);
 }
 
-void staking::unstake(name owner, asset quantity, name code, symbol sym) {
-    
-    require_auth(_self);
-
+// `burn` takes the staked tokens from the owner's balance, otherwise they were transferred here and are retired
+void staking::_apply_unstake(name owner, asset quantity, name code, symbol sym, bool burn) {
     auto itr = _symbols.require_find(sym.code().raw(), "Staked symbol not found");
     check(itr->sname == code, "Incorrect symbol contract");
+    _settle(itr);
 
-    uint128_t ratio = 100000000LL;
-    if (itr->issued.amount > 0) {
-        ratio = ratio * itr->locked.amount / itr->issued.amount;
-    }
-    auto release = asset(quantity.amount * ratio / 100000000LL, TOKEN_SYMBOL);
+    auto release = asset(stakemath::convert(quantity.amount, _unstake_index(*itr)), TOKEN_SYMBOL);
     _symbols.modify(itr, same_payer, [&](auto &s) {
         s.locked -= release;
         s.issued -= quantity;
+        if (s.issued.amount == 0 || !s.stake_index.has_value()) {
+            _refresh_index(s);
+        }
     });
 
-    auto data1 = std::make_tuple(quantity, string("unstake retire"));
-    action(permission_level{_self, "active"_n}, itr->sname, "retire"_n, data1).send();
-    auto data2 = std::make_tuple(_self, owner, release, string("unstake"));
-    action(permission_level{_self, "active"_n}, TOKEN_CONTRACT, "transfer"_n, data2).send();
+    inlineaction::encoder out(_self);
+    if (burn) {
+        out.burnfrom(itr->sname, owner, quantity);
+    } else {
+        out.retire(itr->sname, quantity, MEMO_UNSTAKE_RETIRE);
+    }
+    out.transfer(TOKEN_CONTRACT, _self, owner, release, MEMO_UNSTAKE);
+}
+
+void staking::_setlock(const st_symbol &s, uint32_t granularity) {
+    // the staked token keeps its own copy of the lock time for transfers, granularity 0 derives the bucket width from it
+    auto data = std::make_tuple(s.sym.code(), s.lock_time, granularity);
+    action(permission_level{_self, "active"_n}, s.sname, "setlock"_n, data).send();
+}
+
+void staking::_deposit(name owner, asset quantity) {
+    deposits_mi deposits(_self, _self.value);
+    auto itr = deposits.find(owner.value);
+    if (itr == deposits.end()) {
+        deposits.emplace(_self, [&](auto &d) {
+            d.owner = owner;
+            d.balance = quantity;
+        });
+    } else {
+        deposits.modify(itr, same_payer, [&](auto &d) {
+            d.balance += quantity;
+        });
+    }
+}
+
+void staking::_sub_deposit(name owner, asset quantity) {
+    deposits_mi deposits(_self, _self.value);
+    auto itr = deposits.require_find(owner.value, "No deposit");
+    check(itr->balance >= quantity, "Overdrawn deposit");
+    if (itr->balance == quantity) {
+        deposits.erase(itr);
+    } else {
+        deposits.modify(itr, same_payer, [&](auto &d) {
+            d.balance -= quantity;
+        });
+    }
+}
+
+void staking::_load_epoch() {
+    if (_epoch_loaded) {
+        return;
+    }
+    if (_epochs.exists()) {
+        _epoch = _epochs.get();
+    } else {
+        _epoch = { 28800, 0, 0, asset(0, TOKEN_SYMBOL) };
+    }
+    _epoch_loaded = true;
 }
 
-uint64_t staking::_distribute(symbols_mi::const_iterator sym_itr, uint64_t ift_supply) {
-    uint64_t distribute = uint128_t(ift_supply) * sym_itr->rate / 1000000;
+bool staking::is_staked_token(name self, name code, symbol sym) {
+    symbols_mi symbols(self, self.value);
+    auto itr = symbols.find(sym.code().raw());
+    return itr != symbols.end() && itr->sname == code;
+}
+
+uint64_t staking::_distribute(symbols_mi::const_iterator sym_itr, uint64_t growth, uint64_t total_rate) {
+    // each symbol takes its rate's share of the supply growth
+    uint64_t distribute = stakemath::share(growth, sym_itr->rate, total_rate);
     if (distribute > 0) {
         _symbols.modify(sym_itr, same_payer, [&](auto &s) {
             s.distribute.amount = distribute;
             s.locked.amount += distribute;
+            s.paid_epoch = _epoch.number;
+            _refresh_index(s);
         });
-        auto data1 = std::make_tuple(TOKEN_ISSUER, asset(distribute, TOKEN_SYMBOL), string("distribute"));
-        action(permission_level{TOKEN_ISSUER, "active"_n}, TOKEN_CONTRACT, "issue"_n, data1).send();
-        auto data2 = std::make_tuple(TOKEN_ISSUER, _self, asset(distribute, TOKEN_SYMBOL), string("distribute"));
-        action(permission_level{TOKEN_ISSUER, "active"_n}, TOKEN_CONTRACT, "transfer"_n, data2).send();
     }
     return distribute;
 }
 
+uint64_t staking::_pending_share(const st_symbol &s) {
+    // the symbol's share of the distribution in progress when the pages have not reached it yet
+    _load_epoch();
+    uint64_t cursor = _epoch.cursor.value_or(0);
+    if (cursor == 0 || s.sym.code().raw() < cursor || s.rate == 0 || s.paid_epoch.value_or(0) == _epoch.number) {
+        return 0;
+    }
+    return stakemath::share(_epoch.growth.value(), s.rate, _epoch.rate.value());
+}
+
+void staking::_settle(symbols_mi::const_iterator sym_itr) {
+    // pays the pending share before the exchange rate is used, so a stake or unstake never sees the old rate
+    if (_pending_share(*sym_itr) == 0) {
+        return;
+    }
+    uint64_t distribute = _distribute(sym_itr, _epoch.growth.value(), _epoch.rate.value());
+    _issue(distribute);
+    _epoch.distribute.amount += distribute;
+    _epochs.set(_epoch, _self);
+}
+
+void staking::_issue(uint64_t amount) {
+    // token.ift caps one issue at 1% of the live supply, a long catch-up is minted in steps, at most
+    // MAX_ISSUE_STEPS per call and the rest on the calls after
+    uint64_t remain = _epoch.unminted.value_or(0) + amount;
+    if (remain == 0) {
+        return;
+    }
+    uint64_t supply = get_supply(TOKEN_CONTRACT, TOKEN_SYMBOL.code()).amount;
+    inlineaction::encoder out(TOKEN_ISSUER);
+    for (int steps = 0; remain > 0 && steps < MAX_ISSUE_STEPS; steps++) {
+        uint64_t quantity = std::min(remain, supply / 100);
+        check(quantity > 0, "Supply too small to distribute");
+        out.issueto(TOKEN_CONTRACT, _self, asset(quantity, TOKEN_SYMBOL), MEMO_DISTRIBUTE);
+        supply += quantity;
+        remain -= quantity;
+    }
+    _epoch.unminted = remain;
+}
+
+void staking::_refresh_index(st_symbol &s) {
+    s.stake_index = stakemath::stake_index(s.locked.amount, s.issued.amount);
+    s.unstake_index = stakemath::unstake_index(s.locked.amount, s.issued.amount);
+}
+
+uint128_t staking::_stake_index(const st_symbol &s) {
+    if (s.stake_index.has_value()) {
+        return s.stake_index.value();
+    }
+    st_symbol copy = s;
+    _refresh_index(copy);
+    return copy.stake_index.value();
+}
+
+uint128_t staking::_unstake_index(const st_symbol &s) {
+    if (s.unstake_index.has_value()) {
+        return s.unstake_index.value();
+    }
+    st_symbol copy = s;
+    _refresh_index(copy);
+    return copy.unstake_index.value();
+}
+
+uint64_t staking::_compound(uint64_t supply, uint64_t rate, uint64_t epochs) {
+    return stakemath::compound(supply, rate, epochs);
+}
+
 
-void staking::_stake(name from, asset quantity, symbol_code staked_sc) {
+void staking::_stake(name from, asset quantity, std::string_view memo) {
+    _load_epoch();
     check(_epoch.number > 0, "Stake not started");
     check(quantity.symbol.code() == symbol_code("IFT"), "Invalid token");
     check(quantity.amount > 0, "Stake need greater than zero");
 
-    auto now_ts = current_time_point().sec_since_epoch();
-    if (now_ts > _epoch.end_time) {
-        action(permission_level{_self, "active"_n}, _self, "distribute"_n, std::make_tuple()).send();
+    if (_distribute_due()) {
+        _distribute_page();
     }
 
-    auto data = std::make_tuple(from, quantity, staked_sc);
-    action(permission_level{_self, "active"_n}, _self, "stake"_n, data).send();
+    if (memo.find(':') == std::string_view::npos) {
+        _apply_stake(from, quantity, symbol_code(memo));
+        return;
+    }
+
+    // "SIFT:60,SIFTB:40" stakes the quantity across symbols in proportion to the weights,
+    // the last symbol takes what rounding leaves
+    std::vector<std::pair<symbol_code, uint64_t>> parts;
+    uint64_t total_weight = 0;
+    while (!memo.empty()) {
+        auto comma = memo.find(',');
+        auto part = memo.substr(0, comma);
+        memo = comma == std::string_view::npos ? std::string_view() : memo.substr(comma + 1);
+        auto colon = part.find(':');
+        check(colon != std::string_view::npos && colon + 1 < part.size(), "Invalid split memo");
+        symbol_code sc(part.substr(0, colon));
+        uint64_t weight = 0;
+        for (auto c : part.substr(colon + 1)) {
+            check(c >= '0' && c <= '9' && weight <= MAX_SPLIT_WEIGHT, "Invalid split weight");
+            weight = weight * 10 + (c - '0');
+        }
+        check(weight > 0 && weight <= MAX_SPLIT_WEIGHT, "Invalid split weight");
+        for (auto &p : parts) {
+            check(p.first != sc, "Duplicate symbol in split memo");
+        }
+        parts.emplace_back(sc, weight);
+        total_weight += weight;
+    }
+
+    int64_t remain = quantity.amount;
+    for (size_t i = 0; i < parts.size(); i++) {
+        int64_t amount = i + 1 == parts.size() ? remain : fixedmath::mul_div(quantity.amount, parts[i].second, total_weight);
+        remain -= amount;
+        _apply_stake(from, asset(amount, TOKEN_SYMBOL), parts[i].first);
+    }
 }
 
-void staking::_unstake(name from, asset quantity, name code, symbol sym) {
+void staking::_unstake(name from, asset quantity, name code, symbol sym, bool burn) {
+    _load_epoch();
     check(_epoch.number > 0, "Unstake not started");
     check(quantity.amount > 0, "Unstake need greater than zero");
 
-    auto now_ts = current_time_point().sec_since_epoch();
-    if (now_ts > _epoch.end_time) {
-        action(permission_level{_self, "active"_n}, _self, "distribute"_n, std::make_tuple()).send();
+    if (_distribute_due()) {
+        _distribute_page();
     }
 
-    auto data = std::make_tuple(from, quantity, code, sym);
-    action(permission_level{_self, "active"_n}, _self, "unstake"_n, data).send();
-}
\ No newline at end of file
+    _apply_unstake(from, quantity, code, sym, burn);
+}
+
+
+void staking::dispatch(uint64_t receiver, uint64_t code, uint64_t action) {
+    if (code == receiver) {
+        switch (action) {
+            case "getrate"_n.value:
+                actiondata::execute_query(name(receiver), name(code), &staking::getrate);
+                break;
+            case "nextepoch"_n.value:
+                actiondata::execute_query(name(receiver), name(code), &staking::nextepoch);
+                break;
+            EOSIO_DISPATCH_HELPER(staking, (init)(distribute)(addsymbol)(removesymbol)(updaterate)(updatelock)(stake)(unstake)(unstakeburn)(stakebatch)(withdraw))
+        }
+        return;
+    }
+    if (action != "transfer"_n.value) {
+        return;
+    }
+
+    // from, to and quantity lead the transfer data, check them before the contract touches any table
+    actiondata::reader<actiondata::MAX_MEMO_ACTION_SIZE> data;
+    auto ds = data.stream();
+    if (ds.remaining() < 32) {
+        return;
+    }
+    name from, to;
+    asset quantity;
+    ds >> from >> to >> quantity;
+    if (to.value != receiver || from.value == receiver || from == TOKEN_ISSUER) {
+        return;
+    }
+    if (name(code) != TOKEN_CONTRACT || quantity.symbol != TOKEN_SYMBOL) {
+        check(staking::is_staked_token(name(receiver), name(code), quantity.symbol), "Staked symbol not found");
+    }
+    if (!data.complete()) {
+        // a memo longer than the tokens accept
+        execute_action(name(receiver), name(code), &staking::ontransfer);
+        return;
+    }
+    std::string_view memo;
+    actiondata::read(ds, memo);
+    staking(name(receiver), name(code), data.stream())._ontransfer(from, to, quantity, memo);
+}
+
+extern "C" {
+    void apply(uint64_t receiver, uint64_t code, uint64_t action) {
+        staking::dispatch(receiver, code, action);
+    }
+}